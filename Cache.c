@@ -3,24 +3,127 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdbool.h>
-#include <math.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#if defined(CACHE_PROFILE) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
 
 /*======================================================================*/
 
 /* BEGIN USER Define */
+//Release build (-DCACHE_RELEASE) drops the debug invariant checks, -DCACHE_DEBUG_CHECKS keeps them
+#if !defined(CACHE_RELEASE) && !defined(CACHE_DEBUG_CHECKS)
+#define CACHE_DEBUG_CHECKS
+#endif
+//Self-profiling build (-DCACHE_PROFILE): time per simulator phase, throughput and --progress; compiled out otherwise
+#ifdef CACHE_PROFILE
+#define PROFILE_SCOPE(Phase)  Profile_Scope_Typedef Profile_Scope __attribute__((cleanup(Profile_Scope_End))) = {Phase, Profile_Ticks()}
+#define PROFILE_COUNT(Operation) Profile_Count(Operation)
+#else
+#define PROFILE_SCOPE(Phase)
+#define PROFILE_COUNT(Operation)
+#endif
+#define ALWAYS_INLINE   inline __attribute__((always_inline))
+#ifndef ADDRESS_BIT
+#define ADDRESS_BIT     32         //Trace address width: 32, up to 64 for x86-64/RV64 traces (-DADDRESS_BIT=64)
+#endif
 #define BYTE_BIT        6
 #define SET_BIT         14
-#define TAG_BIT         12
-#define BYTE_MASK       0x0000003F //0000_0000_0000_0000 0000_0000_0011_1111
-#define SET_MASK        0x000FFFC0 //0000_0000_0000_1111 1111_1111_1100_0000
+#define TAG_BIT         (ADDRESS_BIT - SET_BIT - BYTE_BIT) //12 bits for 32-bit addresses
+#define BYTE_MASK       ((1u << BYTE_BIT) - 1)              //0000_0000_0000_0000 0000_0000_0011_1111
+#define SET_MASK        (((1u << SET_BIT) - 1) << BYTE_BIT) //0000_0000_0000_1111 1111_1111_1100_0000
 #define MESI_BIT        2          //4 states ~ 2 bits
 #define DATA_WAYS       4          //4-ways associtive cache
 #define DATA_LRU        DATA_WAYS  //4-ways => max 2 bits
 #define INSTR_WAYS      2          //2-ways associtive cache
 #define INSTR_LRU       INSTR_WAYS //2-ways => max 1 bit
 #define MAX_TRACES      500        //Number of characters allowed in a trace line
-#define NUM_OF_SET      16384      //Total number of set entries
+#define NUM_OF_SET      (1 << SET_BIT) //Total number of set entries
+#define SET_WORDS       ((NUM_OF_SET + 63) / 64) //64-bit words of a per-set bitmap
+#define HIT_LATENCY     1          //L1 hit latency (cycles)
+#define L2_LATENCY      10         //Extra cycles when the line is served by L2
+#define MEM_LATENCY     100        //Extra cycles when the line is also missing in L2
+#define MSHR_ENTRIES    8          //Default number of MSHRs per L1 cache
+#define MAX_MSHR        64         //Upper bound of the MSHR file
+#define DRAM_BANKS      8          //Default number of DRAM banks
+#define MAX_DRAM_BANKS  64         //Upper bound of DRAM banks
+#define DRAM_ROW_SIZE   8192       //Bytes per DRAM row (row buffer size)
+#define DRAM_TRCD       14         //Activate to column command (cycles)
+#define DRAM_TCAS       14         //Column command to data (cycles)
+#define DRAM_TRP        14         //Precharge (cycles)
+#define DRAM_BURST      4          //Bus cycles to transfer one cache line
+#define PAGE_BIT        12         //4KB pages
+#define ITLB_ENTRIES    64         //Instruction TLB: 64 entries, 4 ways
+#define ITLB_WAYS       4
+#define DTLB_ENTRIES    64         //Data TLB: 64 entries, 4 ways
+#define DTLB_WAYS       4
+#define L2_TLB_ENTRIES  1024       //Shared L2 TLB: 1024 entries, 8 ways
+#define L2_TLB_WAYS     8
+#define L2_TLB_LATENCY  7          //Extra cycles for an L2 TLB hit
+#define WALK_LEVELS     4          //Radix page table levels walked on an L2 TLB miss
+#define PTE_PER_LINE    8          //8-byte PTEs in a 64-byte line
+#define LINE_SIZE       (1 << BYTE_BIT)
+#define LINE_WORDS      ((LINE_SIZE + 63) / 64) //64-bit words of a byte usage mask
+#define USAGE_BUCKETS   8          //Histogram buckets of used bytes per line
+#define MAX_JOB_ARGS    64         //Options on one manifest line
+#define SIM_STATE       _Thread_local //Simulation state is per thread, batch jobs run side by side
+#define WORKER_STACK    (64 << 20) //Worker stack, holds the thread-local caches
+#define MAX_STATS_FIELDS 256       //Fields of one statistics snapshot
+#define SHADOW_NIL      UINT32_MAX //End of a shadow cache list
+#define SHADOW_BUCKETS  4          //Shadow cache buckets per line of capacity, most misses find theirs empty
+#define SEEN_FILTER_BIT 24         //Default log2 bits of the 3C seen-before filter, 2MB per cache
+#define SEEN_PROBES     3          //Bits set per line, all in one 64-bit word of the filter
+#define REUSE_BUCKETS   32         //Log2 buckets of the reuse histograms, the last one holds 2^30 and up
+#define REUSE_SLOTS     4096       //Initial time slots of a reuse distance tree (power of 2)
+#define HOT_SETS        8          //Default sets listed by the hot-set report
+#define MAX_HOT_SETS    64
+#define HEAT_VERSION    1          //Binary heatmap format version
+#define HEAVY_HITTERS   10         //Default lines listed by the heavy-hitter report
+#define MAX_HEAVY_HITTERS 64
+#define HEAVY_COUNTERS  1024       //Default counters of a space-saving sketch, counts are off by at most events/counters
+#define REGION_NAME     32         //Characters of a region name, with the terminating 0
+#define PHASE_WEIGHT    0.125      //EWMA weight of the newest window in the phase detector
+#define PHASE_THRESHOLD 4.0        //Default shift, in mean absolute deviations, that flags a phase change
+#define PHASE_MIN_SHIFT 0.05       //Smallest miss ratio shift flagged as a phase change
+#define PHASE_WARMUP    4          //Windows of a phase before it can change
+#define CONVERGE_WINDOW 100000     //Default line accesses per convergence window
+#define CONVERGE_STABLE 5          //Default stable windows before the run stops
+#define HOST_COUNTERS   5          //Host counters read with --perf
+#define TRACE_VERSION   1          //Binary trace format version
+#define TRACE_CHUNK     4096       //Records read or generated at a time
+#define GEN_COUNT       1000000    //Default records of a synthetic trace
+#define GEN_BASE        0x10000000 //Default first data address of a synthetic trace
+#define GEN_FOOTPRINT   (64 << 20) //Default data bytes, 16 times the data cache
+#define GEN_STEP        4096       //Default stride: one line every 64 sets
+#define GEN_THETA       0.99       //Default Zipf skew
+#define GEN_MIX_RATIO   0.3        //Fetches among the records and writes among the data accesses of the mixed pattern
+#define GEN_CODE_BASE   0x00400000 //Fetches walk a code region from here
+#define GEN_CODE_SIZE   (1 << 20)  //Default code bytes
+#define GEN_ZIPF_GROWTH 256        //A Zipf alias table entry covers 1/GEN_ZIPF_GROWTH of its first rank, at least one
+#define GEN_ALIAS_BIT   26         //Resolution of the alias table thresholds
+#define GEN_SCRAMBLE    2654435761u //Prime multiplier spreading the Zipf ranks over the footprint
+#define RV_PAGE_BIT     12         //Pages of the RV32I program memory, allocated on first use
+#define RV_PAGE_MASK    ((1u << RV_PAGE_BIT) - 1)
+#define RV_LABEL        64         //Characters of an assembler label, with the terminating 0
+#define RV_TOKENS       8          //Mnemonic and operands of one assembler line
+#define IMPORT_BLOCK    (1 << 20)  //Bytes of a foreign trace decoded per read
+#define IMPORT_EXPAND   7          //Most records made from one foreign record (ChampSim: fetch, 4 loads, 2 stores)
+#define EVENT_BUFFER    4096       //Events held before one write to the event log
+#define EVENT_VERSION   1          //Event log format version
+#define LOG_RING        65536      //Default records of the asynchronous log ring (power of 2)
+#define LOG_CHUNK       (256 << 10) //Text formatted by the log thread before one write
+#define LOG_WAIT_US     10000      //Longest wait for ring space with the block policy
 /* BEGIN USER Define */
 
 /*======================================================================*/
@@ -37,6 +140,33 @@ typedef enum {
     PRINT_LOG       = 9
 } Operation_Typedef;
 
+/* Address, tag and set storage scale with the geometry
+*  An empty line holds the tag 2^TAG_BIT, so the tag type needs TAG_BIT + 1 bits
+*/
+#if ADDRESS_BIT > 32
+typedef uint64_t Address_Typedef;
+#define ADDR_FMT        "%012" PRIx64
+#else
+typedef uint32_t Address_Typedef;
+#define ADDR_FMT        "%08" PRIx32
+#endif
+#if TAG_BIT < 16
+typedef uint16_t Tag_Typedef;
+#define TAG_FMT         "%04" PRIu16
+#elif TAG_BIT < 32
+typedef uint32_t Tag_Typedef;
+#define TAG_FMT         "%04" PRIu32
+#else
+typedef uint64_t Tag_Typedef;
+#define TAG_FMT         "%04" PRIu64
+#endif
+#if SET_BIT <= 16
+typedef uint16_t Set_Typedef;
+#else
+typedef uint32_t Set_Typedef;
+#endif
+#define EMPTY_TAG       (((Tag_Typedef) 1) << TAG_BIT)
+
 /* Every L1 cache type: LRU/D/V/tag/set/byte 
 *
 *     LRU   D   V       tag          set       byte    Data
@@ -45,47 +175,799 @@ typedef enum {
 *   ----------------------------------------------------------
 */
 typedef struct {
-    uint16_t tag;
-    uint16_t set;
+    Tag_Typedef tag;
+    Set_Typedef set;
     uint8_t LRU_State; //LRU state: 4 for DATA Cache, 2 for INSTRUCTION Cache
     uint8_t Valid;
     uint8_t Dirty;
-    uint32_t address;
+    Address_Typedef address;
 } Cache_Line_Typedef;
+#if ADDRESS_BIT == 32
+_Static_assert(sizeof(Cache_Line_Typedef) == 12, "32-bit cache line must keep its 12-byte footprint");
+#endif
 
 /* Report information: hit times, miss time, read/write access times, hit ratio */
 //L1 Data Cache
 typedef struct {
-    uint32_t Data_Hit;
-    uint32_t Data_Miss;
-    uint32_t Write_Back;
-    uint32_t Data_Read_Access;
-    uint32_t Data_Write_Access;
-    float Data_Hit_Ratio;
+    uint64_t Data_Hit;
+    uint64_t Data_Miss;
+    uint64_t Write_Back;
+    uint64_t Data_Read_Access;
+    uint64_t Data_Write_Access;
+    double Data_Hit_Ratio;
 } Data_Cache_Stats_Typedef;
 
 //L1 Instr Cache
 typedef struct {
-    uint32_t Instruction_Hit;
-    uint32_t Instruction_Miss;
-    uint32_t Instruction_Read_Access;
-    uint32_t Instruction_Write_Access;
-    float Instr_Hit_Ratio;
+    uint64_t Instruction_Hit;
+    uint64_t Instruction_Miss;
+    uint64_t Instruction_Read_Access;
+    uint64_t Instruction_Write_Access;
+    double Instr_Hit_Ratio;
 } Instr_Cache_Stats_Typedef;
+
+/* Outcome of the last L1 operation, filled by the cache operations */
+typedef enum {
+    ACCESS_HIT                   = 0, //Valid line found in L1
+    ACCESS_MISS                  = 1, //Empty way (or invalid matching way) filled from L2
+    ACCESS_MISS_EVICT            = 2, //Clean LRU line evicted, filled from L2
+    ACCESS_MISS_WRITE_BACK       = 3, //Dirty LRU line written to L2, filled from L2
+    ACCESS_MISS_REPLACE          = 4, //Invalidated line replaced, filled from L2
+    ACCESS_INVALIDATE            = 5, //L2 eviction of a clean or absent line
+    ACCESS_INVALIDATE_WRITE_BACK = 6  //L2 eviction of a dirty line
+} Access_Outcome_Typedef;
+
+typedef struct {
+    Access_Outcome_Typedef Outcome;
+    Address_Typedef Victim_Address; //Address of the replaced or written back line
+} Access_Result_Typedef;
+
+/* L2 message sent by an L1 event */
+typedef enum {
+    L2_NONE  = 0, //Hit, or invalidation of a clean line
+    L2_READ  = 1, //Read from L2
+    L2_RFO   = 2, //Read for Ownership from L2
+    L2_WRITE = 3  //Write to L2 of a dirty line evicted by L2
+} L2_Message_Typedef;
+
+/* Binary event log: a header, then one fixed 32-byte record per L1 event
+*  The records replace the Mode 1 messages, Event_Decoder renders them as text
+*/
+typedef struct {
+    char Magic[8];          //"L1EVENT"
+    uint32_t Version;
+    uint32_t Address_Bit;   //ADDRESS_BIT of the simulator that wrote the log
+} Event_Log_Header_Typedef;
+
+typedef struct {
+    uint64_t Index;         //Access number of the cache (0 for an L2 eviction)
+    uint64_t Address;
+    uint64_t Victim;        //Evicted or written back line
+    uint8_t Operation;      //Operation_Typedef
+    uint8_t Outcome;        //Access_Outcome_Typedef
+    uint8_t Message;        //L2_Message_Typedef
+    uint8_t Reserved[5];
+} Cache_Event_Typedef;
+_Static_assert(sizeof(Cache_Event_Typedef) == 32, "event records are 32 bytes on disk");
+
+typedef struct {
+    FILE* File;
+    Cache_Event_Typedef* Buffer;
+    uint32_t Count;
+    uint64_t Events;
+} Event_Log_Typedef;
+
+/* Asynchronous text log: the simulation thread only copies event records into a
+*  single producer / single consumer ring, the log thread formats and writes them
+*/
+typedef enum {
+    LOG_BLOCK = 0, //Wait for space, at most Wait_US, then drop
+    LOG_DROP  = 1  //Drop the record when the ring is full
+} Log_Policy_Typedef;
+
+typedef struct {
+    bool Enable;
+    Log_Policy_Typedef Policy;
+    uint32_t Size;                      //Records, power of 2
+    uint32_t Wait_US;
+    int Show_Hits;                      //Hit_Show of the simulation thread
+    Cache_Event_Typedef* Slot;
+    _Alignas(64) _Atomic uint64_t Head; //Written by the simulation thread
+    uint64_t Tail_Cache;                //Producer copy of Tail, refreshed when the ring looks full
+    uint64_t Enqueued;
+    uint64_t Dropped;
+    uint64_t Full_Waits;                //Times the producer found the ring full
+    _Alignas(64) _Atomic uint64_t Tail; //Written by the log thread
+    _Atomic uint64_t Written;           //Records whose text reached the output stream
+    _Atomic bool Stop;
+    pthread_t Thread;
+} Log_Ring_Typedef;
+
+/* Open addressing hash map keyed by line address
+*  A slot is used only when its stamp equals the current generation, so clearing is O(1)
+*/
+typedef struct {
+    uint64_t Key;
+    uint64_t Value;
+    uint32_t Stamp;
+} Hash_Slot_Typedef; //Key, value and stamp share a cache line, one probe touches one line
+
+typedef struct {
+    Hash_Slot_Typedef *Slot;
+    uint32_t Generation;
+    uint64_t Capacity; //Power of 2
+    uint64_t Count;
+} Hash_Map_Typedef;
+
+/* Shadow fully associative LRU cache of the 3C classification
+*  The resident lines are chained in buckets picked by their L1 set and tag, and linked from most
+*  to least recently used; lines seen since the last reset are kept in a blocked Bloom filter,
+*  whose false positives count a few compulsory misses as capacity misses; lines invalidated by L2
+*  stay in the shadow cache, marked, so that their next miss is told apart from the misses of a too
+*  small cache
+*/
+typedef enum {
+    MISS_COMPULSORY   = 0, //First reference to the line
+    MISS_CAPACITY     = 1, //Also missing in the fully associative cache of the same size
+    MISS_CONFLICT     = 2, //Hit in the fully associative cache, lost to set mapping
+    MISS_INVALIDATION = 3, //Hit in the fully associative cache, invalidated by L2 since its last access
+    MISS_CLASSES      = 4
+} Miss_Class_Typedef;
+
+typedef struct {
+    uint64_t Line;
+    uint32_t Prev;
+    uint32_t Next;
+    uint32_t Chain;         //Next line of the same bucket
+    bool Invalidated;       //Evicted from L1 by L2 since its last access
+} Shadow_Node_Typedef;
+
+typedef struct {
+    uint64_t* Word;         //SEEN_PROBES bits of a line in the word its hash selects
+    uint64_t* Dirty;        //One bit per non-zero word, so a clear only visits those
+    uint64_t Words;         //Power of 2, at least 64
+    uint64_t Bits_Set;
+    uint64_t Lines;         //Lines added since the last clear
+} Seen_Filter_Typedef;
+
+typedef struct {
+    uint32_t* Bucket;       //First resident line of each bucket
+    uint32_t Bucket_Mask;
+    Seen_Filter_Typedef Seen;
+    Shadow_Node_Typedef* Node;
+    uint32_t Head;          //Most recently used node, SHADOW_NIL when empty
+    uint32_t Tail;          //Least recently used node
+    uint32_t Used;          //Nodes handed out since the last clear
+    uint32_t Capacity;      //Lines of the real cache
+} Shadow_Cache_Typedef;
+
+/* Reuse distance and reuse time of one access stream
+*  Every use takes the next time slot; a Fenwick tree marks the slots holding the last use of a line,
+*  so the distinct lines used since a slot are counted in O(log n). Slots are compacted when they run out
+*  Histogram bucket 0 holds 0, bucket k holds 2^(k-1) to 2^k - 1
+*/
+typedef struct {
+    Hash_Map_Typedef Last;              //Line -> slot of its last use
+    uint32_t* Tree;                     //Fenwick tree over the slots (1-based)
+    uint64_t* Slot_Line;                //Line used in each slot
+    uint64_t* Slot_Time;                //Access number of each slot
+    uint32_t Size;                      //Slots, power of 2
+    uint32_t Next;                      //Next free slot
+    uint32_t Live;                      //Slots holding the last use of a line
+    uint64_t Accesses;
+    uint64_t First_Use;                 //Accesses without a previous use of the line
+    uint64_t Distance[REUSE_BUCKETS];   //Distinct lines used between two uses of a line
+    uint64_t Time[REUSE_BUCKETS];       //Accesses between two uses of a line
+} Reuse_Typedef;
+
+/* Per-set counters of one L1 cache for the conflict heatmap (32-bit, they wrap past 2^32 per set) */
+typedef struct {
+    uint32_t Access[NUM_OF_SET];
+    uint32_t Miss[NUM_OF_SET];
+    uint32_t Evict[NUM_OF_SET];         //Valid lines replaced, clean or dirty
+    uint32_t Write_Back[NUM_OF_SET];    //Dirty lines written to L2, on replacement or on an L2 eviction
+} Set_Heat_Typedef;
+
+/* Binary heatmap: a header, then Access, Miss, Evict and Write_Back of the data cache, then of the instruction cache
+*  Every array holds Sets uint32_t in host byte order
+*/
+typedef struct {
+    char Magic[8];          //"L1HEAT"
+    uint32_t Version;
+    uint32_t Sets;
+} Heatmap_Header_Typedef;
+
+/* Space-saving sketch of the lines with the most events, in bounded memory
+*  A min-heap on the counts: an untracked line takes over the smallest counter and inherits its count as error
+*/
+typedef struct {
+    uint64_t Line;
+    uint64_t Count;     //Upper bound of the events of the line
+    uint64_t Error;     //Count - Error is a lower bound
+} Heavy_Counter_Typedef;
+
+typedef struct {
+    Hash_Map_Typedef Index;             //Line -> heap position
+    Heavy_Counter_Typedef* Heap;
+    uint32_t Used;
+    uint32_t Capacity;
+    uint64_t Events;
+    uint32_t Top;                       //Lines sorted by Heavy_Sketch_Sort
+    uint64_t Top_Line[MAX_HEAVY_HITTERS];
+    uint64_t Top_Count[MAX_HEAVY_HITTERS];
+    uint64_t Top_Error[MAX_HEAVY_HITTERS];
+} Heavy_Sketch_Typedef;
+
+/* Address regions (heap, stack, code...) loaded from a region file, statistics are kept per region
+*  Regions are sorted by base for a binary search, the last region found by each stream is tried first
+*  Entry Count of every array is the "(unmapped)" region
+*/
+typedef struct {
+    char Name[REGION_NAME];
+    uint64_t Base;
+    uint64_t Limit;             //Last byte of the region
+} Region_Typedef;
+
+typedef struct {
+    Region_Typedef* Region;
+    uint64_t* Base;             //Bases and limits apart, the binary search only touches these
+    uint64_t* Limit;
+    uint32_t Count;
+    uint32_t Data_Last;         //Region of the last data access
+    uint32_t Instr_Last;        //Region of the last fetch
+    uint32_t Victim_Last;       //Region of the last line written back
+    uint64_t* Data_Hit;
+    uint64_t* Data_Miss;
+    uint64_t* Write_Back;
+    uint64_t* Instr_Hit;
+    uint64_t* Instr_Miss;
+} Region_Table_Typedef;
+
+/* Interval time series: deltas of every window of Length accesses (or cycles) and an online phase detector
+*  The detector follows the EWMA of the window miss ratio and of its absolute deviation, a window whose
+*  miss ratio leaves the band starts a new phase
+*/
+typedef struct {
+    uint64_t Length;            //Window length, 0 when disabled
+    bool Cycles;                //Windows of cycles instead of accesses
+    uint64_t Next;              //Access number or cycle that ends the window
+    uint64_t Total;             //Line accesses since the start
+    uint64_t Accesses;          //Window deltas
+    uint64_t Hits;
+    uint64_t Misses;
+    uint64_t Write_Backs;
+    uint64_t Evictions;
+    uint64_t Windows;
+    double Threshold;           //Band width in mean absolute deviations
+    double Mean;                //EWMA of the miss ratio in the current phase
+    double Deviation;           //EWMA of its absolute deviation
+    uint32_t Phase_Windows;     //Windows seen in the current phase
+    uint32_t Phase;             //Phase changes so far
+    uint64_t Phase_Start;       //Access number where the current phase started
+} Interval_Typedef;
+
+/* Early termination: the running hit ratios are sampled every Window line accesses, the run stops once both
+*  stayed within Tolerance of a reference sample for Windows samples in a row
+*/
+typedef struct {
+    double Tolerance;           //0 when disabled
+    uint64_t Window;
+    uint32_t Windows;
+    uint64_t Total;             //Line accesses since the start
+    uint64_t Next;              //Line access that ends the window
+    bool Reference_Set;
+    double Data_Reference;
+    double Instr_Reference;
+    uint32_t Stable;            //Samples in a row within the tolerance
+    bool Converged;
+    uint64_t Access;            //Line accesses at convergence
+    double Data_Ratio;          //Hit ratios at convergence
+    double Instr_Ratio;
+    uint64_t Reported;          //Line accesses at the last report
+} Convergence_Typedef;
+
+/* Host hardware counters of the simulation thread (perf_event_open, Linux only)
+*  Counts are split between simulation and PRINT_LOG reports, counters the kernel could not open stay at -1
+*/
+typedef struct {
+    bool Enable;
+    int Fd[HOST_COUNTERS];
+    uint64_t Base[HOST_COUNTERS];   //Counts when the counters were opened
+    uint64_t Mark[HOST_COUNTERS];   //Counts when the current report started
+    uint64_t Report[HOST_COUNTERS]; //Counts spent in reports
+} Host_Perf_Typedef;
+
+#ifdef CACHE_PROFILE
+/* Self-profiling: ticks are rdtsc on x86 (clock_gettime ns elsewhere), converted with the wall time of the run
+*  Phases are timed inclusively, the report derives the exclusive time of parsing and dispatch
+*/
+typedef enum {
+    PROFILE_RUN         = 0, //Whole trace loop: reading, parsing and executing
+    PROFILE_EXECUTE     = 1, //Execute_Trace_Operation
+    PROFILE_LOOKUP      = 2, //Tag match in a set
+    PROFILE_REPLACEMENT = 3, //LRU update and victim search
+    PROFILE_LOGGING     = 4, //Mode 1 messages and event log records
+    PROFILE_REPORT      = 5, //PRINT_LOG reports
+    PROFILE_PHASES      = 6
+} Profile_Phase_Typedef;
+
+typedef struct {
+    Profile_Phase_Typedef Phase;
+    uint64_t Start;
+} Profile_Scope_Typedef;
+
+typedef struct {
+    uint64_t Ticks[PROFILE_PHASES];
+    uint64_t Calls[10];         //Trace operations by op code
+    uint64_t Start_Ticks;
+    uint64_t Start_NS;
+    uint64_t Progress_NS;       //Progress line period, 0 for none
+    uint64_t Next_Progress_NS;
+} Profile_Typedef;
+#endif
+
+/* Bytes touched in each resident line and the usage of the lines that left L1 */
+typedef struct {
+    uint64_t Split_Access;                     //Trace accesses that crossed a line boundary
+    uint64_t Retired_Lines;                    //Lines replaced or invalidated since the last reset
+    uint64_t Retired_Bytes;                    //Bytes used by the retired lines
+    uint64_t Used_Histogram[USAGE_BUCKETS];    //Retired lines by used bytes
+    uint64_t Offset_Count[LINE_SIZE];          //Accesses touching each byte offset
+} Byte_Usage_Typedef;
+
+/* Timing model configuration: latencies in cycles */
+typedef struct {
+    bool Enable;
+    uint32_t Hit_Latency;
+    uint32_t L2_Latency;
+    uint32_t Mem_Latency;
+    uint32_t MSHR_Entries;
+} Timing_Config_Typedef;
+
+/* Miss status holding registers of one L1 cache and its timing statistics */
+typedef struct {
+    uint64_t Line[MAX_MSHR];             //Line address (address >> BYTE_BIT) waiting for its fill
+    uint64_t Ready[MAX_MSHR];            //Cycle when the fill returns
+    uint32_t Used;                       //Busy entries
+    uint64_t Last_Cycle;                 //Cycles already accounted in the occupancy histogram
+    uint64_t Accesses;
+    uint64_t Total_Latency;
+    uint64_t Primary_Miss;               //Misses that allocated an MSHR
+    uint64_t Merged_Miss;                //Accesses merged into an outstanding MSHR
+    uint64_t Memory_Fill;                //Primary misses that also missed in L2
+    uint64_t Full_Stall;                 //Misses that found every MSHR busy
+    uint64_t Stall_Cycles;
+    uint64_t Busy_Cycles;                //Cycles with at least one outstanding miss
+    uint64_t Occupancy_Sum;              //Busy entries summed over all cycles
+    uint64_t Occupancy[MAX_MSHR + 1];    //Cycles spent with N busy entries
+} MSHR_File_Typedef;
+
+/* DRAM backend */
+typedef enum {
+    OPEN_PAGE   = 0, //Row stays open after an access
+    CLOSED_PAGE = 1  //Row is precharged after every access
+} DRAM_Policy_Typedef;
+
+typedef struct {
+    bool Enable;
+    DRAM_Policy_Typedef Policy;
+    uint32_t Banks;
+    uint32_t Row_Size;
+    uint32_t tRCD;
+    uint32_t tCAS;
+    uint32_t tRP;
+    uint32_t Burst;
+} DRAM_Config_Typedef;
+
+typedef struct {
+    int64_t Open_Row[MAX_DRAM_BANKS];    //-1 when the bank is precharged
+    uint64_t Bank_Ready[MAX_DRAM_BANKS]; //Cycle when the bank accepts the next command
+    uint64_t Bus_Ready;                  //Cycle when the data bus is free
+    uint64_t Last_Done;                  //Completion of the latest request
+    uint64_t Reads;                      //L2 fills
+    uint64_t Writes;                     //Write-backs
+    uint64_t Row_Hit;
+    uint64_t Row_Empty;
+    uint64_t Row_Conflict;
+    uint64_t Read_Latency;
+    uint64_t Bus_Busy;
+} DRAM_State_Typedef;
+
+/* Address translation */
+typedef enum {
+    ALLOC_SEQUENTIAL = 0, //Frames handed out in order of first touch
+    ALLOC_RANDOM     = 1, //Random free frame
+    ALLOC_COLOR      = 2  //Frame with the same cache color as the virtual page
+} Page_Alloc_Typedef;
+
+typedef struct {
+    bool Enable;
+    uint32_t Page_Bit;
+    uint32_t ITLB_Entries;
+    uint32_t ITLB_Ways;
+    uint32_t DTLB_Entries;
+    uint32_t DTLB_Ways;
+    uint32_t L2_TLB_Entries;
+    uint32_t L2_TLB_Ways;
+    uint32_t L2_TLB_Latency;
+    uint32_t Walk_Levels;
+    Page_Alloc_Typedef Allocation;
+    uint64_t Seed;
+} TLB_Config_Typedef;
+
+/* Set associative TLB with LRU replacement */
+typedef struct {
+    uint32_t Sets;
+    uint32_t Ways;
+    uint64_t *VPN;      //UINT64_MAX when the entry is empty
+    uint64_t *PFN;
+    uint64_t *Last_Use; //LRU stamp
+    uint64_t Clock;
+    uint64_t Hit;
+    uint64_t Miss;
+} TLB_Typedef;
+
+typedef struct {
+    Hash_Map_Typedef Page_Table;  //Hashed page table: VPN -> PFN
+    Hash_Map_Typedef Frame_Owner; //Frames in use: PFN -> VPN of the page given the frame last
+    Hash_Map_Typedef Walk_Lines;  //Page table lines already fetched by the walker
+    uint64_t Next_Frame;          //Sequential allocator
+    uint64_t *Next_In_Color;      //Color allocator: next frame index per color
+    uint32_t Colors;
+    uint64_t Frames;              //Physical frames available
+    uint64_t Random_State;
+    uint64_t Walks;
+    uint64_t Walk_Latency;
+    uint32_t Last_Latency;        //Translation cycles of the last access
+} Translation_State_Typedef;
+/* One executable trace line */
+typedef struct {
+    uint64_t Address;
+    uint32_t Size;
+    uint8_t Operation;
+} Trace_Record_Typedef;
+
+/* Parsed traces shared by the batch workers, each file is parsed once per format */
+typedef struct {
+    char* File_Name;
+    uint8_t Format;         //Trace_Format_Typedef of the jobs sharing the records
+    Trace_Record_Typedef* Records;
+    uint64_t Count;
+    bool Loaded;
+    bool Failed;
+    pthread_mutex_t Lock;
+} Trace_Cache_Typedef;
+
+/* Binary trace: a header, then Trace_Record_Typedef records in host byte order (Size 0 takes --access-size) */
+typedef struct {
+    char Magic[8];          //"L1TRACE"
+    uint32_t Version;
+    uint32_t Record_Size;
+} Trace_File_Header_Typedef;
+
+/* Synthetic trace patterns, picked with the trace name gen:<pattern> */
+typedef enum {
+    GEN_NONE       = 0,
+    GEN_SEQUENTIAL = 1,
+    GEN_STRIDE     = 2,
+    GEN_RANDOM     = 3,
+    GEN_ZIPF       = 4,
+    GEN_CHASE      = 5,
+    GEN_MIX        = 6      //Zipf data accesses with reads, writes and fetches
+} Generator_Pattern_Typedef;
+
+/* Alias table entry of the Zipf pattern (Vose): one uniform draw picks an entry, a second part of it
+*  keeps the entry or takes its alias; an entry covers one rank, or a run of ranks drawn uniformly
+*/
+typedef struct {
+    uint32_t Threshold;         //Draws under it keep the entry, scaled to 2^GEN_ALIAS_BIT
+    uint32_t Alias;
+    uint32_t First;             //First rank, 0 the most popular line
+    uint32_t Ranks;
+} Zipf_Entry_Typedef;
+
+/* Synthetic trace: data addresses follow the pattern over Footprint bytes from Base,
+*  fetches run through a code region with random taken branches; the seed makes a trace repeatable
+*/
+typedef struct {
+    uint8_t Pattern;
+    uint64_t Count;             //Records to generate
+    uint64_t Base;
+    uint64_t Footprint;         //Data bytes
+    uint64_t Stride;            //Bytes between two accesses of the strided pattern
+    uint64_t Code_Size;         //Code bytes
+    uint64_t Seed;
+    uint32_t Size;              //Access size of every record, 0 for --access-size
+    double Theta;               //Zipf skew, between 0 and 1
+    double Write_Ratio;         //Writes among the data accesses, negative for the pattern default
+    double Fetch_Ratio;         //Fetches among the records, negative for the pattern default
+    //Run state
+    uint64_t Done;
+    uint64_t Lines;             //Data lines of the footprint
+    uint64_t Step;              //Bytes between two accesses of the sequential and strided patterns
+    uint64_t Position;          //Byte offset, or line of the pointer chase
+    uint64_t Code_Position;
+    uint64_t Random_State;
+    uint64_t Write_Threshold;   //Ratios scaled to 2^32
+    uint64_t Fetch_Threshold;
+    uint32_t* Next_Line;        //Pointer chase: one cycle through every line
+    Zipf_Entry_Typedef* Zipf_Table;
+    uint32_t Zipf_Entries;
+} Trace_Generator_Typedef;
+
+/* RV32I instructions, in the order of the encoding table */
+typedef enum {
+    RV_LUI = 0, RV_AUIPC, RV_JAL, RV_JALR,
+    RV_BEQ, RV_BNE, RV_BLT, RV_BGE, RV_BLTU, RV_BGEU,
+    RV_LB, RV_LH, RV_LW, RV_LBU, RV_LHU, RV_SB, RV_SH, RV_SW,
+    RV_ADDI, RV_SLTI, RV_SLTIU, RV_XORI, RV_ORI, RV_ANDI, RV_SLLI, RV_SRLI, RV_SRAI,
+    RV_ADD, RV_SUB, RV_SLL, RV_SLT, RV_SLTU, RV_XOR, RV_SRL, RV_SRA, RV_OR, RV_AND,
+    RV_FENCE, RV_ECALL, RV_EBREAK,
+    RV_INSTRUCTIONS
+} RV_Opcode_Typedef;
+
+/* Operand layout of an instruction in the source, and its encoding format */
+typedef enum {
+    RV_FORMAT_R      = 0,   //rd, rs1, rs2
+    RV_FORMAT_I      = 1,   //rd, rs1, imm
+    RV_FORMAT_SHIFT  = 2,   //rd, rs1, shamt
+    RV_FORMAT_LOAD   = 3,   //rd, imm(rs1)
+    RV_FORMAT_STORE  = 4,   //rs2, imm(rs1)
+    RV_FORMAT_BRANCH = 5,   //rs1, rs2, label
+    RV_FORMAT_U      = 6,   //rd, imm20
+    RV_FORMAT_J      = 7,   //[rd,] label
+    RV_FORMAT_JALR   = 8,   //[rd,] imm(rs1)
+    RV_FORMAT_SYSTEM = 9    //No operand
+} RV_Format_Typedef;
+
+typedef struct {
+    const char* Name;
+    uint8_t Format;
+    uint8_t Opcode;         //Bits 6..0 of the instruction word
+    uint8_t Funct3;
+    uint8_t Funct7;         //Bits 31..25, bits 31..20 of fence, ecall and ebreak
+} RV_Encoding_Typedef;
+
+/* Decoded instruction, so the interpreter does not decode a word per step */
+typedef struct {
+    uint8_t Opcode;         //RV_Opcode_Typedef
+    uint8_t Rd;
+    uint8_t Rs1;
+    uint8_t Rs2;
+    int32_t Imm;
+} RV_Instruction_Typedef;
+
+typedef struct {
+    char Name[RV_LABEL];
+    uint32_t Address;
+} RV_Label_Typedef;
+
+/* RV32I machine running a .s trace: the code sits from address 0, registers start at 0,
+*  memory pages are allocated on first use; the code is decoded once, stores to it are not executed
+*/
+typedef struct {
+    RV_Instruction_Typedef* Code;   //One entry per code word
+    uint32_t Words;
+    uint32_t Register[32];
+    uint32_t PC;
+    uint64_t Steps;                 //Instructions executed
+    uint64_t Max_Steps;             //0 for no limit
+    Hash_Map_Typedef Page_Index;    //Page number -> entry of Page
+    uint8_t** Page;
+    uint32_t Pages;
+    uint32_t Last_Number;           //Page of the last access
+    uint8_t* Last_Page;
+    RV_Label_Typedef* Label;
+    uint32_t Labels;
+    bool Fault;
+} RV_Machine_Typedef;
+
+/* Trace formats: native text or binary (told apart by the header), or imported from other tools */
+typedef enum {
+    TRACE_AUTO      = 0,    //From the file extension
+    TRACE_NATIVE    = 1,    //"op address [size]" text or L1TRACE binary
+    TRACE_DINERO    = 2,    //DineroIV din: "label address", 0 read, 1 write, 2 fetch
+    TRACE_CHAMPSIM  = 3,    //ChampSim input_instr records (uncompressed)
+    TRACE_LACKEY    = 4,    //Valgrind --tool=lackey: "I  addr,size", " L/S/M addr,size"
+    TRACE_FORMATS   = 5
+} Trace_Format_Typedef;
+
+/* Instruction record of the ChampSim trace readers */
+typedef struct {
+    uint64_t IP;
+    uint8_t Is_Branch;
+    uint8_t Branch_Taken;
+    uint8_t Destination_Registers[2];
+    uint8_t Source_Registers[4];
+    uint64_t Destination_Memory[2];
+    uint64_t Source_Memory[4];
+} ChampSim_Record_Typedef;
+_Static_assert(sizeof(ChampSim_Record_Typedef) == 64, "ChampSim records are 64 bytes on disk");
+
+/* Streaming decoder of a foreign trace, reading IMPORT_BLOCK bytes at a time */
+typedef struct {
+    FILE* File;
+    uint8_t Format;         //Trace_Format_Typedef
+    char* Block;            //IMPORT_BLOCK bytes, and a 0 after the last one
+    size_t Length;          //Bytes in the block
+    size_t Position;        //Next byte to decode
+    bool End;               //The file has no more bytes than the block
+} Trace_Importer_Typedef;
+
+/* One manifest line: trace file, options and the result record */
+typedef struct {
+    uint32_t Index;
+    char* Line;                 //Manifest line, tokenized in place
+    int Argc;
+    char* Argv[MAX_JOB_ARGS];   //Argv[0] is the trace file
+    Trace_Cache_Typedef* Trace;
+    char* Result;               //Result record (CSV row or JSON object)
+} Batch_Job_Typedef;
+
+/* Growable text used to build export records */
+typedef struct {
+    char* Text;
+    size_t Length;
+    size_t Capacity;
+} Text_Buffer_Typedef;
+
+/* Flat view of every statistic, shared by the JSON and CSV emitters */
+typedef enum {
+    FIELD_COUNTER = 0,
+    FIELD_RATIO   = 1,
+    FIELD_ARRAY   = 2
+} Stats_Field_Kind_Typedef;
+
+typedef struct {
+    const char* Group;        //JSON object / CSV column prefix
+    const char* Name;
+    Stats_Field_Kind_Typedef Kind;
+    uint64_t Counter;
+    double Ratio;
+    const uint64_t* Array;
+    uint32_t Length;
+} Stats_Field_Typedef;
+
+typedef struct {
+    Stats_Field_Typedef Field[MAX_STATS_FIELDS];
+    uint32_t Count;
+} Stats_List_Typedef;
 /* END USER Typedef */
 
 /*======================================================================*/
 
 /* BEGIN USER Variable */
 //Data and Instructino cache declarations
-Cache_Line_Typedef Data_Cache[DATA_WAYS][16384];
-Cache_Line_Typedef Instr_Cache[INSTR_WAYS][16384];
+SIM_STATE Cache_Line_Typedef Data_Cache[DATA_WAYS][NUM_OF_SET];
+SIM_STATE Cache_Line_Typedef Instr_Cache[INSTR_WAYS][NUM_OF_SET];
+//Reset epochs: a set stamped with an older epoch than its cache is empty and cleared on its next use
+SIM_STATE uint32_t Data_Epoch = 0;
+SIM_STATE uint32_t Instr_Epoch = 0;
+SIM_STATE uint32_t Data_Set_Epoch[NUM_OF_SET];
+SIM_STATE uint32_t Instr_Set_Epoch[NUM_OF_SET];
 //Report information declaration
-Data_Cache_Stats_Typedef  Data_Stats_Report;
-Instr_Cache_Stats_Typedef Instr_Stats_Report;
+SIM_STATE Data_Cache_Stats_Typedef  Data_Stats_Report;
+SIM_STATE Instr_Cache_Stats_Typedef Instr_Stats_Report;
 //Debug Mode
-unsigned int Mode = 3;
-int Hit_Show = 0;
+SIM_STATE unsigned int Mode = 3;
+SIM_STATE int Hit_Show = 0;
+//Sets holding valid lines and sets changed since the last PRINT_LOG (one bit per set)
+SIM_STATE uint64_t Data_Valid_Sets[SET_WORDS];
+SIM_STATE uint64_t Instr_Valid_Sets[SET_WORDS];
+SIM_STATE uint64_t Data_Changed_Sets[SET_WORDS];
+SIM_STATE uint64_t Instr_Changed_Sets[SET_WORDS];
+SIM_STATE bool Print_Diff = false; //PRINT_LOG only shows the sets changed since the last one
+//Result of the last cache operation
+SIM_STATE Access_Result_Typedef Access_Result;
+//Line access routine, picked once the report mode is known
+SIM_STATE void (*Simulate_Line_Access)(unsigned int Operation, Address_Typedef address, uint32_t Size) = NULL;
+//Access size and byte usage
+SIM_STATE Byte_Usage_Typedef Data_Usage;
+SIM_STATE Byte_Usage_Typedef Instr_Usage;
+SIM_STATE bool Usage_Enable = false;
+SIM_STATE uint32_t Default_Access_Size = 0;
+SIM_STATE uint64_t Data_Byte_Used[DATA_WAYS][NUM_OF_SET][LINE_WORDS];
+SIM_STATE uint64_t Instr_Byte_Used[INSTR_WAYS][NUM_OF_SET][LINE_WORDS];
+//3C miss classification
+SIM_STATE bool Three_C_Enable = true;
+SIM_STATE Shadow_Cache_Typedef Data_Shadow;
+SIM_STATE Shadow_Cache_Typedef Instr_Shadow;
+SIM_STATE uint8_t Seen_Filter_Bit = SEEN_FILTER_BIT;
+SIM_STATE uint64_t Miss_Class[3][MISS_CLASSES]; //[READ/WRITE/FETCH][Miss_Class_Typedef]
+//Reuse histograms
+SIM_STATE bool Reuse_Enable = false;
+SIM_STATE Reuse_Typedef Data_Reuse;     //Reads and writes
+SIM_STATE Reuse_Typedef Instr_Reuse;    //Fetches
+//Per-set heatmap
+SIM_STATE bool Heat_Enable = false;
+SIM_STATE uint32_t Hot_Sets = 0;        //Sets listed by the hot-set report, 0 for no report
+SIM_STATE Set_Heat_Typedef Data_Heat;
+SIM_STATE Set_Heat_Typedef Instr_Heat;
+SIM_STATE char* Heatmap_CSV_File = NULL;
+SIM_STATE char* Heatmap_Bin_File = NULL;
+SIM_STATE FILE* Heatmap_CSV = NULL;
+SIM_STATE FILE* Heatmap_Bin = NULL;
+//Heavy-hitter lines of the data cache
+SIM_STATE uint32_t Heavy_Hitters = 0;   //Lines listed by the report, 0 when disabled
+SIM_STATE uint32_t Heavy_Counters = HEAVY_COUNTERS;
+SIM_STATE Heavy_Sketch_Typedef Heavy_Miss;
+SIM_STATE Heavy_Sketch_Typedef Heavy_Evict;
+SIM_STATE Heavy_Sketch_Typedef Heavy_Write_Back;
+//Address regions
+SIM_STATE char* Region_File = NULL;
+SIM_STATE Region_Table_Typedef Regions;
+//Interval time series
+SIM_STATE Interval_Typedef Interval = {.Threshold = PHASE_THRESHOLD};
+SIM_STATE char* Interval_CSV_File = NULL;
+SIM_STATE FILE* Interval_CSV = NULL;
+//Early termination
+SIM_STATE Convergence_Typedef Convergence = {.Window = CONVERGE_WINDOW, .Windows = CONVERGE_STABLE};
+//Host hardware counters
+SIM_STATE Host_Perf_Typedef Host_Perf = {.Fd = {-1, -1, -1, -1, -1}};
+//Trace sources
+SIM_STATE bool Binary_Trace = false;
+SIM_STATE Trace_Generator_Typedef Generator = {.Count = GEN_COUNT, .Base = GEN_BASE, .Footprint = GEN_FOOTPRINT, .Stride = GEN_STEP,
+    .Code_Size = GEN_CODE_SIZE, .Seed = 1, .Theta = GEN_THETA, .Write_Ratio = -1.0, .Fetch_Ratio = -1.0};
+//RV32I programs
+SIM_STATE RV_Machine_Typedef RV_Machine;
+//Trace importers
+SIM_STATE uint8_t Trace_Format = TRACE_AUTO;
+const char* Trace_Format_Name[TRACE_FORMATS] = {"auto", "native", "din", "champsim", "lackey"};
+const RV_Encoding_Typedef RV_Encoding[RV_INSTRUCTIONS] = {
+    {"lui", RV_FORMAT_U, 0x37, 0, 0}, {"auipc", RV_FORMAT_U, 0x17, 0, 0}, {"jal", RV_FORMAT_J, 0x6f, 0, 0}, {"jalr", RV_FORMAT_JALR, 0x67, 0, 0},
+    {"beq", RV_FORMAT_BRANCH, 0x63, 0, 0}, {"bne", RV_FORMAT_BRANCH, 0x63, 1, 0}, {"blt", RV_FORMAT_BRANCH, 0x63, 4, 0},
+    {"bge", RV_FORMAT_BRANCH, 0x63, 5, 0}, {"bltu", RV_FORMAT_BRANCH, 0x63, 6, 0}, {"bgeu", RV_FORMAT_BRANCH, 0x63, 7, 0},
+    {"lb", RV_FORMAT_LOAD, 0x03, 0, 0}, {"lh", RV_FORMAT_LOAD, 0x03, 1, 0}, {"lw", RV_FORMAT_LOAD, 0x03, 2, 0},
+    {"lbu", RV_FORMAT_LOAD, 0x03, 4, 0}, {"lhu", RV_FORMAT_LOAD, 0x03, 5, 0},
+    {"sb", RV_FORMAT_STORE, 0x23, 0, 0}, {"sh", RV_FORMAT_STORE, 0x23, 1, 0}, {"sw", RV_FORMAT_STORE, 0x23, 2, 0},
+    {"addi", RV_FORMAT_I, 0x13, 0, 0}, {"slti", RV_FORMAT_I, 0x13, 2, 0}, {"sltiu", RV_FORMAT_I, 0x13, 3, 0},
+    {"xori", RV_FORMAT_I, 0x13, 4, 0}, {"ori", RV_FORMAT_I, 0x13, 6, 0}, {"andi", RV_FORMAT_I, 0x13, 7, 0},
+    {"slli", RV_FORMAT_SHIFT, 0x13, 1, 0x00}, {"srli", RV_FORMAT_SHIFT, 0x13, 5, 0x00}, {"srai", RV_FORMAT_SHIFT, 0x13, 5, 0x20},
+    {"add", RV_FORMAT_R, 0x33, 0, 0x00}, {"sub", RV_FORMAT_R, 0x33, 0, 0x20}, {"sll", RV_FORMAT_R, 0x33, 1, 0x00},
+    {"slt", RV_FORMAT_R, 0x33, 2, 0x00}, {"sltu", RV_FORMAT_R, 0x33, 3, 0x00}, {"xor", RV_FORMAT_R, 0x33, 4, 0x00},
+    {"srl", RV_FORMAT_R, 0x33, 5, 0x00}, {"sra", RV_FORMAT_R, 0x33, 5, 0x20}, {"or", RV_FORMAT_R, 0x33, 6, 0x00}, {"and", RV_FORMAT_R, 0x33, 7, 0x00},
+    {"fence", RV_FORMAT_SYSTEM, 0x0f, 0, 0xff}, {"ecall", RV_FORMAT_SYSTEM, 0x73, 0, 0}, {"ebreak", RV_FORMAT_SYSTEM, 0x73, 0, 1}
+};
+#ifdef CACHE_PROFILE
+//Self-profiling
+SIM_STATE Profile_Typedef Profile;
+#endif
+//Timing model
+SIM_STATE Timing_Config_Typedef Timing_Config = {false, HIT_LATENCY, L2_LATENCY, MEM_LATENCY, MSHR_ENTRIES};
+SIM_STATE MSHR_File_Typedef Data_MSHR;
+SIM_STATE MSHR_File_Typedef Instr_MSHR;
+SIM_STATE uint64_t Sim_Cycle = 0;
+SIM_STATE Hash_Map_Typedef L2_Lines; //Lines held by L2 (L2 is inclusive, it only loses lines on EVICT)
+//DRAM backend
+SIM_STATE DRAM_Config_Typedef DRAM_Config = {false, OPEN_PAGE, DRAM_BANKS, DRAM_ROW_SIZE, DRAM_TRCD, DRAM_TCAS, DRAM_TRP, DRAM_BURST};
+SIM_STATE DRAM_State_Typedef DRAM_State;
+//Address translation
+SIM_STATE TLB_Config_Typedef TLB_Config = {false, PAGE_BIT, ITLB_ENTRIES, ITLB_WAYS, DTLB_ENTRIES, DTLB_WAYS, L2_TLB_ENTRIES, L2_TLB_WAYS, L2_TLB_LATENCY, WALK_LEVELS, ALLOC_SEQUENTIAL, 1};
+SIM_STATE TLB_Typedef ITLB;
+SIM_STATE TLB_Typedef DTLB;
+SIM_STATE TLB_Typedef L2_TLB;
+SIM_STATE Translation_State_Typedef Translation;
+SIM_STATE bool Quiet = false; //Batch jobs only keep the result record
+//Statistics export
+SIM_STATE char* Trace_Name = NULL;
+SIM_STATE char* Stats_JSON_File = NULL;
+SIM_STATE char* Stats_CSV_File = NULL;
+SIM_STATE FILE* Stats_JSON = NULL;
+SIM_STATE FILE* Stats_CSV = NULL;
+SIM_STATE uint64_t Snapshot_Index = 0;
+//Binary event log
+SIM_STATE char* Event_Log_File = NULL;
+SIM_STATE Event_Log_Typedef Event_Log;
+//Asynchronous text log
+SIM_STATE Log_Ring_Typedef Log_Ring = {.Policy = LOG_BLOCK, .Size = LOG_RING, .Wait_US = LOG_WAIT_US};
+//Batch runner (shared by all workers)
+Batch_Job_Typedef* Batch_Jobs = NULL;
+uint32_t Batch_Job_Count = 0;
+uint32_t Batch_Next_Job = 0;
+bool Batch_JSON = false;
+Trace_Cache_Typedef* Trace_Cache = NULL;
+uint32_t Trace_Cache_Count = 0;
+pthread_mutex_t Batch_Lock = PTHREAD_MUTEX_INITIALIZER;
 /* END USER Variable */
 
 /*======================================================================*/
@@ -93,34 +975,262 @@ int Hit_Show = 0;
 /* BEGIN USER PFP */
 bool Reset_And_Clear_Cache();
 unsigned int Selection_Menu();
+bool Parse_Option_Arguments(int argc, char* argv[], int First);
 FILE* Open_Trace_File(char* Trace_File);
 bool Read_and_Run_Trace_File(FILE* fd);
+bool Parse_Trace_Line(char* one_trace_line, unsigned int* tmp_operation, uint64_t* address, unsigned int* size);
+void Execute_Trace_Operation(unsigned int Operation, uint64_t address, unsigned int size);
+bool Simulation_Init();
+void Simulation_Release();
+//Batch runner
+int Run_Batch(int argc, char* argv[]);
+bool Load_Batch_Manifest(char* Manifest_File);
+bool Load_Trace_Records(Trace_Cache_Typedef* Trace);
+void* Batch_Worker(void* Argument);
+void* Batch_Run_Job(void* Argument);
+void Batch_Status_Record(Text_Buffer_Typedef* Buffer, uint32_t Index, const char* Trace, const char* Status);
+void Simulate_Access(unsigned int Operation, Address_Typedef address, uint32_t Size);
+void Simulate_Line_Access_Core(unsigned int Operation, Address_Typedef address, uint32_t Size, const bool Logging);
+void Simulate_Line_Access_Quiet(unsigned int Operation, Address_Typedef address, uint32_t Size);
+void Simulate_Line_Access_Logged(unsigned int Operation, Address_Typedef address, uint32_t Size);
+void Select_Access_Path();
 //Cache operations
-bool Data_Cache_Read(unsigned int address);
-bool Data_Cache_Write(unsigned int address);
-bool Instruction_Cache_Fetch(unsigned int address);
-bool L2_Evict_Command_to_L1(unsigned int address);
+bool Data_Cache_Read(Address_Typedef address);
+bool Data_Cache_Write(Address_Typedef address);
+bool Instruction_Cache_Fetch(Address_Typedef address);
+bool L2_Evict_Command_to_L1(Address_Typedef address);
 bool Print_Content_And_State();
 //Support functions
-int Data_Match_Find(unsigned int Input_Tag, unsigned int Input_Set);
-int Instruction_Match_Find(unsigned int Input_Tag, unsigned int Input_Set);
+int Data_Match_Find(Tag_Typedef Input_Tag, Set_Typedef Input_Set);
+int Instruction_Match_Find(Tag_Typedef Input_Tag, Set_Typedef Input_Set);
 void Data_LRU_State_Update(unsigned int Set_Way, unsigned int Cache_Set, uint8_t Empty_Flag);
 void Instruction_LRU_State_Update(unsigned int Set_Way, unsigned int Cache_Set, uint8_t Empty_Flag);
-int Data_LRU_Smallest_Find(uint16_t Set_Index);
-int Instruction_LRU_Smallest_Find(uint16_t Set_Index);
+int Data_LRU_Smallest_Find(Set_Typedef Set_Index);
+int Instruction_LRU_Smallest_Find(Set_Typedef Set_Index);
+void Data_Set_Refresh(Set_Typedef Set);
+void Instruction_Set_Refresh(Set_Typedef Set);
+void Data_Set_Clear(Set_Typedef Set);
+void Instruction_Set_Clear(Set_Typedef Set);
+char* Option_Value(char* Option, const char* Name);
+//Set bitmaps
+void Set_Bitmap_Fill(uint64_t* Valid_Sets, uint64_t* Changed_Sets, Set_Typedef Set);
+void Set_Bitmap_Invalidate(Set_Typedef Set);
+void Set_Bitmap_Reset();
+void Print_Cache_Sets(bool Instruction, const uint64_t* Sets, bool Diff);
+//Hash map
+uint64_t Hash_Line(uint64_t Key);
+bool Hash_Map_Init(Hash_Map_Typedef* Map, uint64_t Capacity);
+bool Hash_Map_Find(Hash_Map_Typedef* Map, uint64_t Key, uint64_t* Value);
+bool Hash_Map_Insert(Hash_Map_Typedef* Map, uint64_t Key, uint64_t Value);
+bool Hash_Map_Remove(Hash_Map_Typedef* Map, uint64_t Key);
+void Hash_Map_Clear(Hash_Map_Typedef* Map);
+void Hash_Map_Release(Hash_Map_Typedef* Map);
+//3C miss classification
+bool Shadow_Init(Shadow_Cache_Typedef* Shadow, uint32_t Capacity);
+void Shadow_Clear(Shadow_Cache_Typedef* Shadow);
+void Shadow_Unlink(Shadow_Cache_Typedef* Shadow, uint32_t Node);
+uint32_t* Shadow_Bucket(Shadow_Cache_Typedef* Shadow, uint64_t Line);
+uint32_t Shadow_Find(Shadow_Cache_Typedef* Shadow, uint32_t* Bucket, uint64_t Line);
+uint8_t Shadow_Access(Shadow_Cache_Typedef* Shadow, uint64_t Line);
+void Shadow_Invalidate(Shadow_Cache_Typedef* Shadow, uint64_t Line);
+bool Seen_Filter_Init(Seen_Filter_Typedef* Filter, uint8_t Bit);
+bool Seen_Filter_Add(Seen_Filter_Typedef* Filter, uint64_t Line);
+void Seen_Filter_Clear(Seen_Filter_Typedef* Filter);
+void Seen_Filter_Release(Seen_Filter_Typedef* Filter);
+double Seen_Filter_False_Positive(Seen_Filter_Typedef* Filter);
+bool Miss_Class_Init();
+void Miss_Class_Access(unsigned int Operation, Address_Typedef address);
+void Miss_Class_Invalidate(Address_Typedef address);
+void Miss_Class_Reset();
+void Miss_Class_Release();
+void Print_Miss_Class_Report();
+//Reuse histograms
+bool Reuse_Init(Reuse_Typedef* Reuse);
+void Reuse_Reset(Reuse_Typedef* Reuse);
+void Reuse_Release(Reuse_Typedef* Reuse);
+void Reuse_Tree_Add(Reuse_Typedef* Reuse, uint32_t Slot, int32_t Delta);
+uint32_t Reuse_Tree_Prefix(Reuse_Typedef* Reuse, uint32_t Slot);
+bool Reuse_Compact(Reuse_Typedef* Reuse);
+uint32_t Reuse_Bucket(uint64_t Value);
+void Reuse_Access(Reuse_Typedef* Reuse, uint64_t Line);
+uint64_t Reuse_LRU_Hits(Reuse_Typedef* Reuse, uint64_t Lines);
+void Print_Reuse_Report();
+//Per-set heatmap
+void Set_Heat_Access(unsigned int Operation, Address_Typedef address);
+void Set_Heat_Invalidate(Address_Typedef address);
+void Set_Heat_Reset();
+void Heatmap_Export();
+void Print_Hot_Sets_Report();
+//Heavy-hitter lines
+bool Heavy_Sketch_Init(Heavy_Sketch_Typedef* Sketch, uint32_t Capacity);
+void Heavy_Sketch_Clear(Heavy_Sketch_Typedef* Sketch);
+void Heavy_Sketch_Release(Heavy_Sketch_Typedef* Sketch);
+void Heavy_Sketch_Sift_Up(Heavy_Sketch_Typedef* Sketch, uint32_t Position, Heavy_Counter_Typedef Entry);
+void Heavy_Sketch_Sift_Down(Heavy_Sketch_Typedef* Sketch, uint32_t Position, Heavy_Counter_Typedef Entry);
+void Heavy_Sketch_Add(Heavy_Sketch_Typedef* Sketch, uint64_t Line);
+void Heavy_Sketch_Sort(Heavy_Sketch_Typedef* Sketch, uint32_t Top);
+bool Heavy_Hitters_Init();
+void Heavy_Hitters_Access(Address_Typedef address);
+void Heavy_Hitters_Invalidate();
+void Heavy_Hitters_Reset();
+void Heavy_Hitters_Release();
+void Print_Heavy_Hitters_Report(bool Final);
+//Address regions
+int Region_Compare(const void* First, const void* Second);
+bool Region_Load();
+uint32_t Region_Find(uint64_t address, uint32_t* Last);
+void Region_Access(unsigned int Operation, Address_Typedef address);
+void Region_Invalidate(uint64_t address);
+void Region_Reset();
+void Region_Release();
+void Print_Region_Report();
+//Interval time series
+bool Interval_Open();
+void Interval_Access();
+void Interval_Invalidate();
+void Interval_Flush();
+void Interval_Close();
+void Print_Interval_Report();
+//Early termination
+void Convergence_Access();
+void Convergence_Reset();
+void Print_Convergence_Report();
+//Host hardware counters
+bool Host_Perf_Open();
+void Host_Perf_Read(uint64_t* Values);
+void Host_Perf_Simulation(uint64_t* Values);
+void Host_Perf_Report_Begin();
+void Host_Perf_Report_End();
+void Host_Perf_Close();
+void Print_Host_Perf_Report(bool Final);
+//Trace sources
+bool Read_Trace_Header(FILE* fd, bool* Binary);
+void Execute_Trace_Records(const Trace_Record_Typedef* Records, uint64_t Count);
+bool Run_Binary_Trace(FILE* fd);
+bool Run_Generated_Trace();
+bool Parse_Generator_Option(char* Option);
+bool Generator_Select(char* Pattern);
+bool Generator_Init(Trace_Generator_Typedef* Gen);
+void Generator_Release(Trace_Generator_Typedef* Gen);
+uint64_t Generator_Random(uint64_t* State);
+double Generator_Log(double X);
+double Generator_Exp(double X);
+double Generator_Power(double X, double Y);
+bool Generator_Zipf_Init(Trace_Generator_Typedef* Gen);
+uint64_t Generator_Zipf(Trace_Generator_Typedef* Gen, uint64_t Random);
+uint64_t Generator_Fill(Trace_Generator_Typedef* Gen, Trace_Record_Typedef* Records, uint64_t Count);
+//RV32I programs
+bool RV_Source_File(const char* Trace_File);
+bool RV_Run_Program(FILE* fd);
+bool RV_Assemble(RV_Machine_Typedef* Machine, FILE* fd);
+bool RV_Assemble_Line(RV_Machine_Typedef* Machine, char* Line, bool Emit, uint32_t* PC);
+bool RV_Register(const char* Token, uint8_t* Register);
+bool RV_Immediate(const char* Token, int64_t* Value);
+bool RV_Target(RV_Machine_Typedef* Machine, const char* Token, bool Emit, uint32_t PC, int64_t* Offset);
+bool RV_Emit(RV_Machine_Typedef* Machine, bool Emit, uint32_t* PC, uint8_t Opcode, uint8_t Rd, uint8_t Rs1, uint8_t Rs2, int64_t Imm);
+uint32_t RV_Encode(uint8_t Opcode, uint8_t Rd, uint8_t Rs1, uint8_t Rs2, int32_t Imm);
+bool RV_Decode(uint32_t Word, RV_Instruction_Typedef* Instruction);
+int32_t RV_Sign_Extend(uint32_t Value, uint8_t Bits);
+uint8_t* RV_Page(RV_Machine_Typedef* Machine, uint32_t Address);
+uint32_t RV_Load(RV_Machine_Typedef* Machine, uint32_t Address, uint8_t Size);
+void RV_Store(RV_Machine_Typedef* Machine, uint32_t Address, uint32_t Value, uint8_t Size);
+void RV_Run(RV_Machine_Typedef* Machine);
+void RV_Release(RV_Machine_Typedef* Machine);
+//Trace importers
+bool Trace_Format_Select(const char* Name);
+uint8_t Trace_Format_Detect(const char* Trace_File);
+bool Run_Imported_Trace(FILE* fd);
+bool Import_Init(Trace_Importer_Typedef* Importer, FILE* fd, uint8_t Format);
+void Import_Release(Trace_Importer_Typedef* Importer);
+bool Import_Refill(Trace_Importer_Typedef* Importer);
+char* Import_Line(Trace_Importer_Typedef* Importer);
+uint64_t Import_Hex(const char** Text);
+uint64_t Import_Fill(Trace_Importer_Typedef* Importer, Trace_Record_Typedef* Records, uint64_t Count);
+uint8_t Import_Dinero(const char* Line, Trace_Record_Typedef* Records);
+uint8_t Import_Lackey(const char* Line, Trace_Record_Typedef* Records);
+uint8_t Import_ChampSim(const ChampSim_Record_Typedef* Instruction, Trace_Record_Typedef* Records);
+#ifdef CACHE_PROFILE
+//Self-profiling
+uint64_t Profile_NS();
+uint64_t Profile_Ticks();
+void Profile_Scope_End(Profile_Scope_Typedef* Scope);
+void Profile_Start();
+void Profile_Count(unsigned int Operation);
+void Profile_Progress();
+void Print_Profile_Report();
+#endif
+//Timing model
+void Timing_Model_Reset();
+void Timing_Model_Advance(MSHR_File_Typedef* MSHR, uint64_t Target);
+void Timing_Model_Access(MSHR_File_Typedef* MSHR, Address_Typedef address);
+void Timing_Model_Evict(Address_Typedef address);
+void Print_Timing_Report();
+//DRAM backend
+void DRAM_Reset();
+uint64_t DRAM_Access(Address_Typedef address, bool Write, uint64_t Arrival);
+void Print_DRAM_Report();
+//Address translation
+bool Parse_TLB_Geometry(char* Value, uint32_t* Entries, uint32_t* Ways);
+bool TLB_Init(TLB_Typedef* TLB, uint32_t Entries, uint32_t Ways);
+void TLB_Flush(TLB_Typedef* TLB);
+bool TLB_Lookup(TLB_Typedef* TLB, uint64_t VPN, uint64_t* PFN);
+void TLB_Insert(TLB_Typedef* TLB, uint64_t VPN, uint64_t PFN);
+bool Translation_Init();
+void Translation_Reset();
+uint64_t Page_Allocate(uint64_t VPN);
+uint64_t Page_Walk(uint64_t VPN);
+Address_Typedef Translate_Address(Address_Typedef address, bool Instruction);
+Address_Typedef Translate_Without_TLB(Address_Typedef address);
+Address_Typedef Translate_Reverse(Address_Typedef address);
+void Print_Translation_Report();
+//Byte usage
+void Byte_Usage_Retire(Byte_Usage_Typedef* Usage, uint64_t* Mask);
+void Byte_Usage_Touch(Byte_Usage_Typedef* Usage, uint64_t* Mask, uint32_t Offset, uint32_t Size);
+void Byte_Usage_Access(unsigned int Operation, Address_Typedef address, uint32_t Size);
+void Byte_Usage_Invalidate(Address_Typedef address);
+void Byte_Usage_Reset();
+void Print_Byte_Usage_Report();
+//Statistics export
+void Text_Append(Text_Buffer_Typedef* Buffer, const char* Format, ...);
+void Text_Append_JSON_String(Text_Buffer_Typedef* Buffer, const char* Text);
+void Text_Append_CSV_Field(Text_Buffer_Typedef* Buffer, const char* Text);
+void Stats_Add_Counter(Stats_List_Typedef* List, const char* Group, const char* Name, uint64_t Counter);
+void Stats_Add_Ratio(Stats_List_Typedef* List, const char* Group, const char* Name, double Ratio);
+void Stats_Add_Array(Stats_List_Typedef* List, const char* Group, const char* Name, const uint64_t* Array, uint32_t Length);
+void Collect_Stats_Fields(Stats_List_Typedef* List);
+void Format_Stats_JSON(Text_Buffer_Typedef* Buffer, const char* Reason);
+void Format_Stats_CSV(Text_Buffer_Typedef* Buffer, const char* Reason, bool Header);
+void Export_Stats_Snapshot(const char* Reason);
+//Event log
+bool Event_Log_Open();
+void Event_Log_Flush();
+void Event_Log_Close();
+void Log_Cache_Event(unsigned int Operation, Address_Typedef address);
+int Format_Cache_Event(char* Text, size_t Size, const Cache_Event_Typedef* Event, int Show_Hits);
+void Print_Cache_Event(FILE* Output, const Cache_Event_Typedef* Event, int Show_Hits);
+//Asynchronous log
+bool Async_Log_Start();
+void Async_Log_Push(const Cache_Event_Typedef* Event);
+void* Async_Log_Thread(void* Argument);
+void Async_Log_Drain();
+void Async_Log_Stop();
 /* END USER PFP */
 
 /*======================================================================*/
 
 /* BEGIN MAIN PROGRAM */
+#ifndef CACHE_NO_MAIN //Tools include this file without its main
 int main(int argc, char* argv[])
 {    
     /* BEGIN Main: Local variable */
     char *trace_file_name;    
     FILE *fd = NULL;
+    int First_Option = 2;
     /* END Main: Local variable */
     
     /* BEGIN Code */
+    //Batch mode never prompts: ./Cache.exe --batch=<manifest> [--jobs=N] [--output=<file>]
+    if ((argc > 1) && (strncmp(argv[1], "--batch", 7) == 0)) return Run_Batch(argc, argv);
     //Check input traces and hit_show parameter
     printf("\033[32m==============================================================================================================\033[0m\n");
     printf("\033[32m\t\t\t\t\033[4;1mINITIALIZATION:\033[0m\n");
@@ -132,9 +1242,34 @@ int main(int argc, char* argv[])
     else
     {
         trace_file_name = argv[1];
+        Trace_Name = trace_file_name;
         printf("\033[32;4;1m1. Trace file name:\033[0m\033[32m %s\n\033[0m", trace_file_name);
     }
-    if (argc > 2) Hit_Show = atoi(argv[2]);
+    if ((argc > 2) && (argv[2][0] != '-'))
+    {
+        Hit_Show = atoi(argv[2]);
+        First_Option = 3;
+    }
+    if (Parse_Option_Arguments(argc, argv, First_Option) == false)
+    {
+        printf("\033[31mERROR: Invalid option!\033[0m\n");
+        exit(1);
+    }
+    if (Simulation_Init() == false)
+    {
+        printf("\033[31mERROR: Cannot allocate the simulation models!\033[0m\n");
+        exit(1);
+    }
+    if (Timing_Config.Enable)
+    {
+        printf("\033[32m   Timing model: hit %u, L2 %u, memory %u cycles, %u MSHRs\n\033[0m", Timing_Config.Hit_Latency, Timing_Config.L2_Latency, Timing_Config.Mem_Latency, Timing_Config.MSHR_Entries);
+    }
+    if (TLB_Config.Enable)
+    {
+        printf("\033[32m   Translation: %u-byte pages, ITLB %u/%u-way, DTLB %u/%u-way, L2 TLB %u/%u-way\n\033[0m", 1u << TLB_Config.Page_Bit, TLB_Config.ITLB_Entries, TLB_Config.ITLB_Ways, TLB_Config.DTLB_Entries, TLB_Config.DTLB_Ways, TLB_Config.L2_TLB_Entries, TLB_Config.L2_TLB_Ways);
+    }
+    if (Event_Log.File != NULL) printf("\033[32m   Event log: %s (messages between L1 and L2 are written in binary)\n\033[0m", Event_Log_File);
+    if (DRAM_Config.Enable) printf("\033[32m   DRAM: %u banks, %u-byte rows, %s page, tRCD-tCAS-tRP %u-%u-%u\n\033[0m", DRAM_Config.Banks, DRAM_Config.Row_Size, (DRAM_Config.Policy == OPEN_PAGE) ? "open" : "closed", DRAM_Config.tRCD, DRAM_Config.tCAS, DRAM_Config.tRP);
     //Clear cache and stats
     printf("\033[32;4;1m2. Resetting all cache lines and stats...\033[0m\n");
     if (Reset_And_Clear_Cache()) printf("\033[32m\t   => DONE\033[0m\n");
@@ -144,17 +1279,52 @@ int main(int argc, char* argv[])
         exit(1);
     }
 
-    //Select report mode
-    Mode = (unsigned int) Selection_Menu();
+    //Select report mode, unless given with --mode; a trace read from stdin leaves no input for the menu
+    if ((Mode > 1) && (strcmp(trace_file_name, "-") == 0)) Mode = 0;
+    if (Mode > 1) Mode = (unsigned int) Selection_Menu();
+    Select_Access_Path();
+    //The log thread only serves Mode 1 messages printed to stdout, the event log writes its own file
+    Log_Ring.Enable = Log_Ring.Enable && (Mode > 0) && (Event_Log.File == NULL);
+    if (Log_Ring.Enable && (Async_Log_Start() == false))
+    {
+        printf("\033[31mERROR: Cannot start the log thread!\033[0m\n");
+        exit(1);
+    }
     //Read trace file    
-    if ((fd = Open_Trace_File(trace_file_name))) printf("\033[32;4;1m4. Trace file is opened successfully!\033[0m\n");
+    if (Generator.Pattern != GEN_NONE) printf("\033[32;4;1m4. Synthetic trace: %s, %" PRIu64 " records, seed %" PRIu64 "\033[0m\n", &trace_file_name[4], Generator.Count, Generator.Seed);
+    else if ((fd = Open_Trace_File(trace_file_name))) printf("\033[32;4;1m4. Trace file is opened successfully!\033[0m\n");
     else printf("\033[31mERROR: Cannot open trace file!\033[0m\n");
+    if ((fd != NULL) && (Trace_Format > TRACE_NATIVE)) printf("\033[32m   Imported format: %s\n\033[0m", Trace_Format_Name[Trace_Format]);
     
     printf("\033[32m==============================================================================================================\033[0m\n");
     //Read and Run the Simulation
     if (Mode > 0) printf("\033[33m==============================================================================================================\033[0m\n");
     printf("\033[33m\t\t\t\t\033[4;1mMESSAGE BETWEEN L1 AND L2:\033[0m\n");
+#ifdef CACHE_PROFILE
+    Profile_Start();
+#endif
     if (Read_and_Run_Trace_File(fd) == false) printf("\033[31mERROR: Cannot read and simulate trace file!\033[0m\n");
+#ifdef CACHE_PROFILE
+    Print_Profile_Report();
+#endif
+    if (Host_Perf.Enable) Print_Host_Perf_Report(true);
+    //The verdicts follow the queued Mode 1 messages
+    Async_Log_Drain();
+    //The rest of the trace, with its PRINT_LOG, is skipped: report the state at convergence
+    if (Convergence.Converged)
+    {
+        printf("\033[32m   Hit ratios converged after %" PRIu64 " line accesses, the rest of the trace is skipped\n\033[0m", Convergence.Access);
+        Print_Content_And_State();
+    }
+    //Not converged and no PRINT_LOG since the last access (a trace that does not end with one): the verdict is still due
+    else if ((Convergence.Tolerance > 0.0) && (Convergence.Reported != Convergence.Total))
+    {
+        printf("\033[32m   Hit ratios did not converge in %" PRIu64 " line accesses\n\033[0m", Convergence.Total);
+        Print_Content_And_State();
+    }
+    if (Heavy_Hitters > 0) Print_Heavy_Hitters_Report(true);
+    Export_Stats_Snapshot("final");
+    Simulation_Release();
     
     //FINISH MESSAGE
     printf("\033[32;1m\t\t\t\t\t\tTEST FINISHED!\033[0m\n");
@@ -162,6 +1332,7 @@ int main(int argc, char* argv[])
 
     return 0;
 }
+#endif
 /* END MAIN PROGRAM */
 
 /*======================================================================*/
@@ -170,33 +1341,17 @@ int main(int argc, char* argv[])
 bool Reset_And_Clear_Cache()
 {
     bool OK = false;    
-    uint16_t Tag_Mask = pow(2, TAG_BIT);
-    uint16_t Nums_of_Sets = pow(2, SET_BIT);
-    //Clearing Data Cache Lines
-    for (uint8_t i = 0; i < DATA_WAYS; i++)
-    {                
-        for(unsigned int j = 0; j < Nums_of_Sets; j++)
-        {                    
-            Data_Cache[i][j].tag = Tag_Mask;
-            Data_Cache[i][j].set = 0;
-            Data_Cache[i][j].LRU_State = 0;
-            Data_Cache[i][j].Valid = 0;
-            Data_Cache[i][j].Dirty = 0;
-            Data_Cache[i][j].address = 0;
-        }                   
+
+    //O(1) clear of both caches: start a new epoch, each set is cleared when it is next touched
+    if (++Data_Epoch == 0)
+    {
+        memset(Data_Set_Epoch, 0, sizeof(Data_Set_Epoch));
+        Data_Epoch = 1;
     }
-    //Clear Instruction Cache Lines
-    for (uint8_t i = 0; i < INSTR_WAYS; i++)
-    {        
-        for (unsigned int j = 0; j < Nums_of_Sets; j++)
-        {
-            Instr_Cache[i][j].tag = Tag_Mask;
-            Instr_Cache[i][j].set = 0;
-            Instr_Cache[i][j].LRU_State = 0;
-            Instr_Cache[i][j].Valid = 0;
-            Instr_Cache[i][j].Dirty = 0;
-            Instr_Cache[i][j].address = 0;
-        }        
+    if (++Instr_Epoch == 0)
+    {
+        memset(Instr_Set_Epoch, 0, sizeof(Instr_Set_Epoch));
+        Instr_Epoch = 1;
     }
     //Clear Data Stats Information
     Data_Stats_Report.Data_Hit = 0;
@@ -210,6 +1365,30 @@ bool Reset_And_Clear_Cache()
     Instr_Stats_Report.Instruction_Read_Access = 0;
     Instr_Stats_Report.Instruction_Write_Access = 0;
     Instr_Stats_Report.Instr_Hit_Ratio = 0.0;
+    //Every populated set is emptied
+    Set_Bitmap_Reset();
+    //Clear Timing Information
+    Timing_Model_Reset();
+    //Flush TLBs
+    if (TLB_Config.Enable) Translation_Reset();
+    //Clear Byte Usage Information
+    Byte_Usage_Reset();
+    //Forget the lines seen so far
+    if (Three_C_Enable) Miss_Class_Reset();
+    //Clear reuse histograms
+    if (Reuse_Enable)
+    {
+        Reuse_Reset(&Data_Reuse);
+        Reuse_Reset(&Instr_Reuse);
+    }
+    //Clear per-set counters
+    if (Heat_Enable) Set_Heat_Reset();
+    //Forget the heavy-hitter lines
+    if (Heavy_Hitters > 0) Heavy_Hitters_Reset();
+    //Clear region statistics
+    if (Region_File != NULL) Region_Reset();
+    //The hit ratios start over
+    if (Convergence.Tolerance > 0.0) Convergence_Reset();
 
     return OK = true;    
 }
@@ -230,93 +1409,724 @@ unsigned int Selection_Menu()
     return mode;
 }
 
+bool Parse_Option_Arguments(int argc, char* argv[], int First)
+{
+    char* Value = NULL;
+
+    for (int i = First; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--timing")) Timing_Config.Enable = true;
+        else if ((Value = Option_Value(argv[i], "--hit-latency"))) Timing_Config.Hit_Latency = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--l2-latency"))) Timing_Config.L2_Latency = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--mem-latency"))) Timing_Config.Mem_Latency = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--mshr"))) Timing_Config.MSHR_Entries = strtoul(Value, NULL, 0);
+        else if (!strcmp(argv[i], "--dram")) DRAM_Config.Enable = Timing_Config.Enable = true;
+        else if ((Value = Option_Value(argv[i], "--dram-policy")))
+        {
+            if (!strcmp(Value, "open")) DRAM_Config.Policy = OPEN_PAGE;
+            else if (!strcmp(Value, "closed")) DRAM_Config.Policy = CLOSED_PAGE;
+            else return false;
+        }
+        else if ((Value = Option_Value(argv[i], "--dram-banks"))) DRAM_Config.Banks = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--dram-row"))) DRAM_Config.Row_Size = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--trcd"))) DRAM_Config.tRCD = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--tcas"))) DRAM_Config.tCAS = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--trp"))) DRAM_Config.tRP = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--dram-burst"))) DRAM_Config.Burst = strtoul(Value, NULL, 0);
+        else if (!strcmp(argv[i], "--tlb")) TLB_Config.Enable = true;
+        else if ((Value = Option_Value(argv[i], "--page-size")))
+        {
+            TLB_Config.Page_Bit = 0;
+            for (unsigned long Size = strtoul(Value, NULL, 0); Size > 1; Size >>= 1) TLB_Config.Page_Bit++;
+        }
+        else if ((Value = Option_Value(argv[i], "--itlb")))
+        {
+            if (Parse_TLB_Geometry(Value, &TLB_Config.ITLB_Entries, &TLB_Config.ITLB_Ways) == false) return false;
+        }
+        else if ((Value = Option_Value(argv[i], "--dtlb")))
+        {
+            if (Parse_TLB_Geometry(Value, &TLB_Config.DTLB_Entries, &TLB_Config.DTLB_Ways) == false) return false;
+        }
+        else if ((Value = Option_Value(argv[i], "--l2tlb")))
+        {
+            if (Parse_TLB_Geometry(Value, &TLB_Config.L2_TLB_Entries, &TLB_Config.L2_TLB_Ways) == false) return false;
+        }
+        else if ((Value = Option_Value(argv[i], "--l2tlb-latency"))) TLB_Config.L2_TLB_Latency = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--walk-levels"))) TLB_Config.Walk_Levels = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--page-alloc")))
+        {
+            if (!strcmp(Value, "sequential")) TLB_Config.Allocation = ALLOC_SEQUENTIAL;
+            else if (!strcmp(Value, "random")) TLB_Config.Allocation = ALLOC_RANDOM;
+            else if (!strcmp(Value, "color")) TLB_Config.Allocation = ALLOC_COLOR;
+            else return false;
+        }
+        else if ((Value = Option_Value(argv[i], "--page-seed"))) TLB_Config.Seed = strtoull(Value, NULL, 0);
+        else if (!strcmp(argv[i], "--byte-usage")) Usage_Enable = true;
+        else if ((Value = Option_Value(argv[i], "--access-size"))) Default_Access_Size = strtoul(Value, NULL, 0);
+        else if (!strcmp(argv[i], "--print-diff")) Print_Diff = true;
+        else if (!strcmp(argv[i], "--3c")) Three_C_Enable = true;
+        else if (!strcmp(argv[i], "--no-3c")) Three_C_Enable = false;
+        else if ((Value = Option_Value(argv[i], "--3c-filter"))) Seen_Filter_Bit = strtoul(Value, NULL, 0);
+        else if (!strcmp(argv[i], "--reuse")) Reuse_Enable = true;
+        else if ((Value = Option_Value(argv[i], "--heatmap-csv"))) Heatmap_CSV_File = Value;
+        else if ((Value = Option_Value(argv[i], "--heatmap-bin"))) Heatmap_Bin_File = Value;
+        else if (!strcmp(argv[i], "--hot-sets")) Hot_Sets = HOT_SETS;
+        else if ((Value = Option_Value(argv[i], "--hot-sets"))) Hot_Sets = strtoul(Value, NULL, 0);
+        else if (!strcmp(argv[i], "--heavy-hitters")) Heavy_Hitters = HEAVY_HITTERS;
+        else if ((Value = Option_Value(argv[i], "--heavy-hitters"))) Heavy_Hitters = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--heavy-counters"))) Heavy_Counters = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--regions"))) Region_File = Value;
+        else if ((Value = Option_Value(argv[i], "--interval"))) Interval.Length = strtoull(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--interval-cycles")))
+        {
+            Interval.Length = strtoull(Value, NULL, 0);
+            Interval.Cycles = Timing_Config.Enable = true;
+        }
+        else if ((Value = Option_Value(argv[i], "--interval-csv"))) Interval_CSV_File = Value;
+        else if ((Value = Option_Value(argv[i], "--phase-threshold"))) Interval.Threshold = strtod(Value, NULL);
+        else if ((Value = Option_Value(argv[i], "--converge"))) Convergence.Tolerance = strtod(Value, NULL);
+        else if ((Value = Option_Value(argv[i], "--converge-window"))) Convergence.Window = strtoull(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--converge-windows"))) Convergence.Windows = strtoul(Value, NULL, 0);
+        else if (!strcmp(argv[i], "--perf")) Host_Perf.Enable = true;
+#ifdef CACHE_PROFILE
+        else if ((Value = Option_Value(argv[i], "--progress"))) Profile.Progress_NS = (uint64_t)(strtod(Value, NULL) * 1e9);
+#endif
+        else if ((Value = Option_Value(argv[i], "--mode"))) Mode = (strtoul(Value, NULL, 0) > 0) ? 1 : 0;
+        else if ((Value = Option_Value(argv[i], "--stats-json"))) Stats_JSON_File = Value;
+        else if ((Value = Option_Value(argv[i], "--stats-csv"))) Stats_CSV_File = Value;
+        else if ((Value = Option_Value(argv[i], "--event-log"))) Event_Log_File = Value;
+        else if (!strcmp(argv[i], "--async-log")) Log_Ring.Enable = true;
+        else if ((Value = Option_Value(argv[i], "--async-log")))
+        {
+            Log_Ring.Enable = true;
+            if (!strcmp(Value, "block")) Log_Ring.Policy = LOG_BLOCK;
+            else if (!strcmp(Value, "drop")) Log_Ring.Policy = LOG_DROP;
+            else return false;
+        }
+        else if ((Value = Option_Value(argv[i], "--log-ring"))) Log_Ring.Size = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--log-wait"))) Log_Ring.Wait_US = strtoul(Value, NULL, 0);
+        else if (Parse_Generator_Option(argv[i])) continue;
+        else if ((Value = Option_Value(argv[i], "--max-instructions"))) RV_Machine.Max_Steps = strtoull(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--trace-format")))
+        {
+            if (Trace_Format_Select(Value) == false) return false;
+        }
+        else
+        {
+            printf("\033[31mERROR: Unknown option %s\033[0m\n", argv[i]);
+            return false;
+        }
+    }
+    if (Hot_Sets > MAX_HOT_SETS)
+    {
+        printf("\033[31mERROR: The hot-set report lists at most %d sets\033[0m\n", MAX_HOT_SETS);
+        return false;
+    }
+    if ((Heavy_Hitters > MAX_HEAVY_HITTERS) || (Heavy_Counters < Heavy_Hitters) || (Heavy_Counters < 1))
+    {
+        printf("\033[31mERROR: The heavy-hitter report lists at most %d lines, with at least as many counters\033[0m\n", MAX_HEAVY_HITTERS);
+        return false;
+    }
+    if ((Seen_Filter_Bit < 12) || (Seen_Filter_Bit > 34))
+    {
+        printf("\033[31mERROR: The 3C filter takes 2^12 to 2^34 bits\033[0m\n");
+        return false;
+    }
+    if ((Interval.Length > 0) != (Interval_CSV_File != NULL))
+    {
+        printf("\033[31mERROR: --interval or --interval-cycles goes with --interval-csv\033[0m\n");
+        return false;
+    }
+    if ((Convergence.Tolerance < 0.0) || (Convergence.Window < 1) || (Convergence.Windows < 1))
+    {
+        printf("\033[31mERROR: Convergence needs a positive tolerance, window and number of windows\033[0m\n");
+        return false;
+    }
+    if ((Trace_Name != NULL) && (strncmp(Trace_Name, "gen:", 4) == 0) && (Generator_Select(&Trace_Name[4]) == false)) return false;
+    if (Trace_Format == TRACE_AUTO) Trace_Format = Trace_Format_Detect(Trace_Name);
+    Heat_Enable = (Hot_Sets > 0) || (Heatmap_CSV_File != NULL) || (Heatmap_Bin_File != NULL);
+    if ((Timing_Config.MSHR_Entries < 1) || (Timing_Config.MSHR_Entries > MAX_MSHR))
+    {
+        printf("\033[31mERROR: MSHR entries must be between 1 and %d\033[0m\n", MAX_MSHR);
+        return false;
+    }
+    if ((DRAM_Config.Banks < 1) || (DRAM_Config.Banks > MAX_DRAM_BANKS) || (DRAM_Config.Row_Size < (1 << BYTE_BIT)))
+    {
+        printf("\033[31mERROR: DRAM needs 1 to %d banks and rows of at least one line\033[0m\n", MAX_DRAM_BANKS);
+        return false;
+    }
+    if ((TLB_Config.Page_Bit < BYTE_BIT) || (TLB_Config.Page_Bit > 30) || (TLB_Config.Walk_Levels < 1))
+    {
+        printf("\033[31mERROR: Page size must be a power of 2 between one line and 1GB\033[0m\n");
+        return false;
+    }
+    if ((Log_Ring.Size < 2) || (Log_Ring.Size & (Log_Ring.Size - 1)))
+    {
+        printf("\033[31mERROR: The log ring size must be a power of 2\033[0m\n");
+        return false;
+    }
+    return true;
+}
+
 FILE* Open_Trace_File(char* Trace_File)
 {        
-    FILE *fd = fopen(Trace_File, "r");    
+    //"-" reads the trace from stdin, e.g. piped from Tools/Trace_Gen.c
+    FILE *fd = strcmp(Trace_File, "-") ? fopen(Trace_File, "r") : stdin;    
     if (fd == NULL)
     {        
         return NULL;
     }
+    //RV32I sources are assembled and foreign formats imported, neither has the native header
+    else if ((RV_Source_File(Trace_File) == false) && (Trace_Format == TRACE_NATIVE) && (Read_Trace_Header(fd, &Binary_Trace) == false))
+    {
+        if (fd != stdin) fclose(fd);
+        return NULL;
+    }
     else return fd;
 }
 
 bool Read_and_Run_Trace_File(FILE* fd)
 {
+    PROFILE_SCOPE(PROFILE_RUN);
     bool OK = false;
 
     char one_trace_line[MAX_TRACES];
-    char* comments = NULL;
     unsigned int tmp_operation;    
-    uint32_t address;
+    uint64_t address;
+    unsigned int size;
 
-    while (fgets(one_trace_line, MAX_TRACES, fd) != NULL)
+    if (Generator.Pattern != GEN_NONE) return Run_Generated_Trace();
+    if (fd == NULL) return OK;
+    if (RV_Source_File(Trace_Name)) return RV_Run_Program(fd);
+    if (Trace_Format != TRACE_NATIVE) return Run_Imported_Trace(fd);
+    if (Binary_Trace) return Run_Binary_Trace(fd);
+    while ((Convergence.Converged == false) && (fgets(one_trace_line, MAX_TRACES, fd) != NULL))
     {          
-        sscanf(one_trace_line, "%u %x %c", &tmp_operation, &address, comments);        
-        if (one_trace_line[0]=='#'||!strcmp(one_trace_line, "\n")||!strcmp(one_trace_line, " ")||!strcmp(one_trace_line, "/")||!strcmp(one_trace_line, "*")||!strcmp(one_trace_line, "=")||(tmp_operation > 9)) __asm__("nop");
-        else
-        {            
-            switch (tmp_operation)
-            {
-            case READ:                
-                Data_Cache_Read(address);                          
-                break;
-            
-            case WRITE:
-                Data_Cache_Write(address);
-                break;
-            
-            case FETCH:
-                Instruction_Cache_Fetch(address);                             
-                break;
+        if (Parse_Trace_Line(one_trace_line, &tmp_operation, &address, &size)) Execute_Trace_Operation(tmp_operation, address, size);
+    }
+    return OK = true;
+}
 
-            case EVICT:                
-                L2_Evict_Command_to_L1(address);                                
-                break;                
+bool Parse_Trace_Line(char* one_trace_line, unsigned int* tmp_operation, uint64_t* address, unsigned int* size)
+{
+    //Fields that fail to parse keep the value of the previous line
+    //Optional access size after the address: "op address [size]"
+    if (sscanf(one_trace_line, "%u %" SCNx64 " %u", tmp_operation, address, size) < 3) *size = Default_Access_Size;
+    if (one_trace_line[0]=='#'||!strcmp(one_trace_line, "\n")||!strcmp(one_trace_line, " ")||!strcmp(one_trace_line, "/")||!strcmp(one_trace_line, "*")||!strcmp(one_trace_line, "=")||(*tmp_operation > 9)) return false;
+    return true;
+}
 
-            case RESET_AND_CLEAR:
-                Reset_And_Clear_Cache();                                              
-                break;
+void Execute_Trace_Operation(unsigned int Operation, uint64_t address, unsigned int size)
+{
+    uint64_t Trace_Address = address; //Regions are given in trace addresses
+    PROFILE_SCOPE(PROFILE_EXECUTE);
 
-            case PRINT_LOG:                
-                Print_Content_And_State();
-                break;
+    PROFILE_COUNT(Operation);
+    switch (Operation)
+    {
+    case READ:                
+    case WRITE:
+    case FETCH:
+        Simulate_Access(Operation, address, size);
+        break;
 
-            default:
-                printf("\033[1;31mERROR: Ivalid operation!\033[1;0m\n");
-                break;
-            }
-        }
+    case EVICT:                
+        if (TLB_Config.Enable) address = Translate_Without_TLB(address);
+        if ((L2_Evict_Command_to_L1(address) == false) && ((Mode > 0) || (Event_Log.File != NULL))) Log_Cache_Event(Operation, address);
+        if (Timing_Config.Enable) Timing_Model_Evict(address);
+        if (Usage_Enable) Byte_Usage_Invalidate(address);
+        if (Three_C_Enable) Miss_Class_Invalidate(address);
+        if (Heat_Enable) Set_Heat_Invalidate(address);
+        if (Heavy_Hitters > 0) Heavy_Hitters_Invalidate();
+        if (Region_File != NULL) Region_Invalidate(Trace_Address);
+        if (Interval.Length > 0) Interval_Invalidate();
+        break;                
+
+    case RESET_AND_CLEAR:
+        Reset_And_Clear_Cache();                                              
+        break;
+
+    case PRINT_LOG:                
+        Print_Content_And_State();
+        break;
+
+    default:
+        printf("\033[1;31mERROR: Ivalid operation!\033[1;0m\n");
+        break;
     }
-    return OK = true;
 }
 
-//Cache operations
-bool Data_Cache_Read(unsigned int address)
+bool Simulation_Init()
 {
-    uint16_t Tag = address >> (SET_BIT + BYTE_BIT);
-    uint16_t Set = (address & SET_MASK) >> BYTE_BIT;
-    int Selected_Cache_Way = -1;
-    uint8_t Empty_Flag = 0;
+    bool OK = true;
 
-    Data_Stats_Report.Data_Read_Access++;
-    Selected_Cache_Way = Data_Match_Find(Tag, Set);        
-    if (Selected_Cache_Way > -1)
+    if (Timing_Config.Enable) OK = OK && Hash_Map_Init(&L2_Lines, 1 << 16);
+    if (TLB_Config.Enable) OK = OK && Translation_Init();
+    if (Three_C_Enable) OK = OK && Miss_Class_Init();
+    if (Reuse_Enable) OK = OK && Reuse_Init(&Data_Reuse) && Reuse_Init(&Instr_Reuse);
+    if (Heavy_Hitters > 0) OK = OK && Heavy_Hitters_Init();
+    if (Region_File != NULL) OK = OK && Region_Load();
+    if (Interval.Length > 0) OK = OK && Interval_Open();
+    if (Generator.Pattern != GEN_NONE) OK = OK && Generator_Init(&Generator);
+    //Missing perf support only drops the host counters
+    if (Host_Perf.Enable) Host_Perf.Enable = Host_Perf_Open();
+    if (Stats_JSON_File != NULL) OK = OK && ((Stats_JSON = fopen(Stats_JSON_File, "w")) != NULL);
+    if (Stats_CSV_File != NULL) OK = OK && ((Stats_CSV = fopen(Stats_CSV_File, "w")) != NULL);
+    if (Heatmap_CSV_File != NULL) OK = OK && ((Heatmap_CSV = fopen(Heatmap_CSV_File, "w")) != NULL);
+    if (Heatmap_Bin_File != NULL) OK = OK && ((Heatmap_Bin = fopen(Heatmap_Bin_File, "wb")) != NULL);
+    if (Event_Log_File != NULL) OK = OK && Event_Log_Open();
+    Select_Access_Path();
+    return OK;
+}
+
+void Simulation_Release()
+{
+    Hash_Map_Typedef* Maps[4] = {&L2_Lines, &Translation.Page_Table, &Translation.Frame_Owner, &Translation.Walk_Lines};
+    TLB_Typedef* TLB[3] = {&ITLB, &DTLB, &L2_TLB};
+
+    for (uint8_t i = 0; i < 4; i++) Hash_Map_Release(Maps[i]);
+    for (uint8_t i = 0; i < 3; i++)
     {
-        if (Data_Cache[Selected_Cache_Way][Set].Valid)
-        {
-            Data_Stats_Report.Data_Hit++;
-            Data_Cache[Selected_Cache_Way][Set].tag = Tag;
-            Data_Cache[Selected_Cache_Way][Set].set = Set;
-            Data_Cache[Selected_Cache_Way][Set].Valid = Data_Cache[Selected_Cache_Way][Set].Valid;
-            Data_Cache[Selected_Cache_Way][Set].Dirty = Data_Cache[Selected_Cache_Way][Set].Dirty;
-            Data_Cache[Selected_Cache_Way][Set].address = address;
-            Data_LRU_State_Update(Selected_Cache_Way, Set, Empty_Flag);
-            if ((Mode > 0) && (Hit_Show == 1)) printf("\033[33m[READ ACCESS %6u] L1(DATA)  READ HIT <0x%08x>\033[0m\n", Data_Stats_Report.Data_Read_Access, address);
-        }        
-        else
+        free(TLB[i]->VPN);
+        free(TLB[i]->PFN);
+        free(TLB[i]->Last_Use);
+    }
+    free(Translation.Next_In_Color);
+    Miss_Class_Release();
+    Reuse_Release(&Data_Reuse);
+    Reuse_Release(&Instr_Reuse);
+    Heatmap_Export();
+    Heavy_Hitters_Release();
+    Region_Release();
+    Interval_Close();
+    Host_Perf_Close();
+    Generator_Release(&Generator);
+    if (Stats_JSON != NULL) fclose(Stats_JSON);
+    if (Stats_CSV != NULL) fclose(Stats_CSV);
+    Stats_JSON = Stats_CSV = NULL;
+    Event_Log_Close();
+    Async_Log_Stop();
+}
+
+//Batch runner
+int Run_Batch(int argc, char* argv[])
+{
+    char* Manifest_File = Option_Value(argv[1], "--batch");
+    char* Output_File = NULL;
+    char* Value = NULL;
+    FILE* Output = stdout;
+    uint32_t Workers = 4;
+    pthread_t* Worker = NULL;
+    pthread_attr_t Attribute;
+
+#ifdef _SC_NPROCESSORS_ONLN
+    if (sysconf(_SC_NPROCESSORS_ONLN) > 0) Workers = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    for (int i = 2; i < argc; i++)
+    {
+        if ((Value = Option_Value(argv[i], "--jobs"))) Workers = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--output"))) Output_File = Value;
+        else if ((Value = Option_Value(argv[i], "--format")))
+        {
+            if (!strcmp(Value, "csv")) Batch_JSON = false;
+            else if (!strcmp(Value, "json")) Batch_JSON = true;
+            else
+            {
+                fprintf(stderr, "ERROR: Unknown batch format %s (csv or json)\n", Value);
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "ERROR: Unknown batch option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if ((Manifest_File == NULL) || (Load_Batch_Manifest(Manifest_File) == false))
+    {
+        fprintf(stderr, "ERROR: Cannot read the batch manifest!\n");
+        return 1;
+    }
+    if ((Output_File != NULL) && ((Output = fopen(Output_File, "w")) == NULL))
+    {
+        fprintf(stderr, "ERROR: Cannot open %s\n", Output_File);
+        return 1;
+    }
+    if (Workers < 1) Workers = 1;
+    if (Workers > Batch_Job_Count) Workers = Batch_Job_Count;
+    Worker = (pthread_t*) malloc(Workers * sizeof(pthread_t));
+    pthread_attr_init(&Attribute);
+    pthread_attr_setstacksize(&Attribute, WORKER_STACK);
+    for (uint32_t i = 0; i < Workers; i++) pthread_create(&Worker[i], &Attribute, Batch_Worker, NULL);
+    for (uint32_t i = 0; i < Workers; i++) pthread_join(Worker[i], NULL);
+    pthread_attr_destroy(&Attribute);
+
+    //One result record per job, in manifest order
+    if (Batch_JSON == false) fprintf(Output, "job,trace,status,data_reads,data_writes,data_hits,data_misses,write_backs,data_hit_ratio,instr_reads,instr_hits,instr_misses,instr_hit_ratio,cycles,amat\n");
+    for (uint32_t i = 0; i < Batch_Job_Count; i++)
+    {
+        fprintf(Output, "%s\n", Batch_Jobs[i].Result);
+        free(Batch_Jobs[i].Result);
+    }
+    if (Output != stdout) fclose(Output);
+    free(Worker);
+    return 0;
+}
+
+bool Load_Batch_Manifest(char* Manifest_File)
+{
+    FILE* fd = fopen(Manifest_File, "r");
+    char one_line[MAX_TRACES];
+    char* Token;
+    char* Value;
+    uint8_t Format;
+    Batch_Job_Typedef* Job;
+
+    if (fd == NULL) return false;
+    while (fgets(one_line, MAX_TRACES, fd) != NULL)
+    {
+        //Manifest line: <trace file> [options...], '#' starts a comment
+        if ((Token = strchr(one_line, '#'))) *Token = '\0';
+        if (strspn(one_line, " \t\r\n") == strlen(one_line)) continue;
+        Batch_Jobs = (Batch_Job_Typedef*) realloc(Batch_Jobs, (Batch_Job_Count + 1) * sizeof(Batch_Job_Typedef));
+        Job = &Batch_Jobs[Batch_Job_Count];
+        memset(Job, 0, sizeof(Batch_Job_Typedef));
+        Job->Index = Batch_Job_Count++;
+        Job->Line = strdup(one_line);
+        for (Token = strtok(Job->Line, " \t\r\n"); (Token != NULL) && (Job->Argc < MAX_JOB_ARGS); Token = strtok(NULL, " \t\r\n")) Job->Argv[Job->Argc++] = Token;
+    }
+    fclose(fd);
+    //Jobs naming the same trace in the same format share one parsed copy
+    Trace_Cache = (Trace_Cache_Typedef*) calloc(Batch_Job_Count + 1, sizeof(Trace_Cache_Typedef));
+    for (uint32_t i = 0; i < Batch_Job_Count; i++)
+    {
+        Job = &Batch_Jobs[i];
+        //Resolved like Parse_Option_Arguments does: the last --trace-format, else the extension
+        Format = Trace_Format_Detect(Job->Argv[0]);
+        for (int j = 1; j < Job->Argc; j++)
+        {
+            if ((Value = Option_Value(Job->Argv[j], "--trace-format")) == NULL) continue;
+            for (uint8_t k = TRACE_NATIVE; k < TRACE_FORMATS; k++)
+            {
+                if (!strcmp(Value, Trace_Format_Name[k])) Format = k;
+            }
+        }
+        for (uint32_t j = 0; (Job->Trace == NULL) && (j < Trace_Cache_Count); j++)
+        {
+            if (!strcmp(Trace_Cache[j].File_Name, Job->Argv[0]) && (Trace_Cache[j].Format == Format)) Job->Trace = &Trace_Cache[j];
+        }
+        if (Job->Trace == NULL)
+        {
+            Job->Trace = &Trace_Cache[Trace_Cache_Count++];
+            Job->Trace->File_Name = Job->Argv[0];
+            Job->Trace->Format = Format;
+            pthread_mutex_init(&Job->Trace->Lock, NULL);
+        }
+    }
+    return Batch_Job_Count > 0;
+}
+
+bool Load_Trace_Records(Trace_Cache_Typedef* Trace)
+{
+    FILE* fd;
+    char one_trace_line[MAX_TRACES];
+    unsigned int tmp_operation = 0;
+    uint64_t address = 0;
+    unsigned int size = 0;
+    uint64_t Capacity = 1024;
+    size_t Count;
+    bool Binary = false;
+    Trace_Importer_Typedef Importer;
+
+    //The first job that needs the trace parses it, the others wait and reuse the records
+    pthread_mutex_lock(&Trace->Lock);
+    if ((Trace->Loaded == false) && (Trace->Failed == false))
+    {
+        if ((fd = fopen(Trace->File_Name, "r")) == NULL) Trace->Failed = true;
+        else if ((Trace->Format == TRACE_NATIVE) ? (Read_Trace_Header(fd, &Binary) == false) : (Import_Init(&Importer, fd, Trace->Format) == false))
+        {
+            fclose(fd);
+            Trace->Failed = true;
+        }
+        else if (Trace->Format != TRACE_NATIVE)
+        {
+            Trace->Records = (Trace_Record_Typedef*) malloc(Capacity * sizeof(Trace_Record_Typedef));
+            while (true)
+            {
+                while (Capacity - Trace->Count < TRACE_CHUNK)
+                {
+                    Capacity *= 2;
+                    Trace->Records = (Trace_Record_Typedef*) realloc(Trace->Records, Capacity * sizeof(Trace_Record_Typedef));
+                }
+                if ((Count = Import_Fill(&Importer, &Trace->Records[Trace->Count], TRACE_CHUNK)) == 0) break;
+                Trace->Count += Count;
+            }
+            Import_Release(&Importer);
+            fclose(fd);
+            Trace->Loaded = true;
+        }
+        else
+        {
+            Trace->Records = (Trace_Record_Typedef*) malloc(Capacity * sizeof(Trace_Record_Typedef));
+            while (Binary && ((Count = fread(&Trace->Records[Trace->Count], sizeof(Trace_Record_Typedef), Capacity - Trace->Count, fd)) > 0))
+            {
+                Trace->Count += Count;
+                if (Trace->Count == Capacity)
+                {
+                    Capacity *= 2;
+                    Trace->Records = (Trace_Record_Typedef*) realloc(Trace->Records, Capacity * sizeof(Trace_Record_Typedef));
+                }
+            }
+            while ((Binary == false) && (fgets(one_trace_line, MAX_TRACES, fd) != NULL))
+            {
+                //Sizes are resolved per job, keep 0 when the line has none
+                if (sscanf(one_trace_line, "%u %" SCNx64 " %u", &tmp_operation, &address, &size) < 3) size = 0;
+                if (one_trace_line[0]=='#'||!strcmp(one_trace_line, "\n")||!strcmp(one_trace_line, " ")||!strcmp(one_trace_line, "/")||!strcmp(one_trace_line, "*")||!strcmp(one_trace_line, "=")||(tmp_operation > 9)) continue;
+                if (Trace->Count == Capacity)
+                {
+                    Capacity *= 2;
+                    Trace->Records = (Trace_Record_Typedef*) realloc(Trace->Records, Capacity * sizeof(Trace_Record_Typedef));
+                }
+                Trace->Records[Trace->Count].Operation = tmp_operation;
+                Trace->Records[Trace->Count].Address = address;
+                Trace->Records[Trace->Count].Size = size;
+                Trace->Count++;
+            }
+            fclose(fd);
+            Trace->Loaded = true;
+        }
+    }
+    pthread_mutex_unlock(&Trace->Lock);
+    return Trace->Loaded;
+}
+
+void* Batch_Worker(void* Argument)
+{
+    pthread_t Job_Thread;
+    pthread_attr_t Attribute;
+    uint32_t Index;
+    Text_Buffer_Typedef Record = {NULL, 0, 0};
+
+    (void) Argument;
+    pthread_attr_init(&Attribute);
+    pthread_attr_setstacksize(&Attribute, WORKER_STACK);
+    while (true)
+    {
+        pthread_mutex_lock(&Batch_Lock);
+        Index = Batch_Next_Job++;
+        pthread_mutex_unlock(&Batch_Lock);
+        if (Index >= Batch_Job_Count) break;
+        //Every job gets a fresh thread, so its thread-local state starts from the program defaults
+        if (pthread_create(&Job_Thread, &Attribute, Batch_Run_Job, &Batch_Jobs[Index]) == 0) pthread_join(Job_Thread, NULL);
+        else
+        {
+            Batch_Status_Record(&Record, Index, Batch_Jobs[Index].Argv[0], "thread_error");
+            Batch_Jobs[Index].Result = Record.Text;
+            Record.Text = NULL;
+            Record.Length = Record.Capacity = 0;
+        }
+    }
+    pthread_attr_destroy(&Attribute);
+    return NULL;
+}
+
+void* Batch_Run_Job(void* Argument)
+{
+    Batch_Job_Typedef* Job = (Batch_Job_Typedef*) Argument;
+    Text_Buffer_Typedef Result = {NULL, 0, 0};
+    uint64_t Accesses;
+    FILE* Program;
+    const char* Failure = NULL;
+
+    Quiet = true;
+    Mode = 0;
+    Trace_Name = Job->Argv[0];
+    if ((Parse_Option_Arguments(Job->Argc, Job->Argv, 1) == false) || (Simulation_Init() == false))
+    {
+        Batch_Status_Record(&Result, Job->Index, Job->Argv[0], "bad_options");
+        Job->Result = Result.Text;
+        return NULL;
+    }
+    //Jobs only produce the result record
+    Mode = 0;
+    Select_Access_Path();
+    //Synthetic traces and RV32I programs depend on the job options, every job generates its own
+    if ((Generator.Pattern == GEN_NONE) && (RV_Source_File(Trace_Name) == false) && (Load_Trace_Records(Job->Trace) == false))
+    {
+        Batch_Status_Record(&Result, Job->Index, Job->Argv[0], "bad_trace");
+        Job->Result = Result.Text;
+        Simulation_Release();
+        return NULL;
+    }
+    Reset_And_Clear_Cache();
+    if (Generator.Pattern != GEN_NONE) Run_Generated_Trace();
+    else if (RV_Source_File(Trace_Name))
+    {
+        //A program that does not assemble or faults has no meaningful statistics
+        if ((Program = fopen(Trace_Name, "r")) == NULL) Failure = "bad_trace";
+        else
+        {
+            if (RV_Run_Program(Program) == false) Failure = "bad_program";
+            fclose(Program);
+        }
+    }
+    else Execute_Trace_Records(Job->Trace->Records, Job->Trace->Count);
+    if (Failure != NULL)
+    {
+        Batch_Status_Record(&Result, Job->Index, Job->Argv[0], Failure);
+        Job->Result = Result.Text;
+        Simulation_Release();
+        return NULL;
+    }
+    Export_Stats_Snapshot("final");
+    Accesses = Data_MSHR.Accesses + Instr_MSHR.Accesses;
+    if (Batch_JSON)
+    {
+        Text_Append(&Result, "{\"job\":%u,\"status\":\"ok\",\"stats\":", Job->Index);
+        Format_Stats_JSON(&Result, "final");
+        Text_Append(&Result, "}");
+    }
+    else
+    {
+        Text_Append(&Result, "%u,", Job->Index);
+        Text_Append_CSV_Field(&Result, Job->Argv[0]);
+        Text_Append(&Result, ",ok,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%1.6f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%1.6f,%" PRIu64 ",%1.4f",
+        Data_Stats_Report.Data_Read_Access, Data_Stats_Report.Data_Write_Access, Data_Stats_Report.Data_Hit,
+        Data_Stats_Report.Data_Miss, Data_Stats_Report.Write_Back,
+        (Data_Stats_Report.Data_Hit + Data_Stats_Report.Data_Miss == 0) ? 0.0 : (double) Data_Stats_Report.Data_Hit / (Data_Stats_Report.Data_Hit + Data_Stats_Report.Data_Miss),
+        Instr_Stats_Report.Instruction_Read_Access, Instr_Stats_Report.Instruction_Hit, Instr_Stats_Report.Instruction_Miss,
+        (Instr_Stats_Report.Instruction_Hit + Instr_Stats_Report.Instruction_Miss == 0) ? 0.0 : (double) Instr_Stats_Report.Instruction_Hit / (Instr_Stats_Report.Instruction_Hit + Instr_Stats_Report.Instruction_Miss),
+        Sim_Cycle, (Accesses == 0) ? 0.0 : (double)(Data_MSHR.Total_Latency + Instr_MSHR.Total_Latency) / Accesses);
+    }
+    Job->Result = Result.Text;
+    Simulation_Release();
+    return NULL;
+}
+
+//Record of a job that ran no simulation
+void Batch_Status_Record(Text_Buffer_Typedef* Buffer, uint32_t Index, const char* Trace, const char* Status)
+{
+    if (Batch_JSON)
+    {
+        Text_Append(Buffer, "{\"job\":%u,\"trace\":", Index);
+        Text_Append_JSON_String(Buffer, Trace);
+        Text_Append(Buffer, ",\"status\":\"%s\"}", Status);
+    }
+    else
+    {
+        Text_Append(Buffer, "%u,", Index);
+        Text_Append_CSV_Field(Buffer, Trace);
+        Text_Append(Buffer, ",%s", Status);
+    }
+}
+
+void Simulate_Access(unsigned int Operation, Address_Typedef address, uint32_t Size)
+{
+    Address_Typedef Next_Line;
+
+    //An access crossing a line boundary is split into one lookup per line
+    if ((Size > 0) && ((address & BYTE_MASK) + Size > LINE_SIZE))
+    {
+        Byte_Usage_Typedef* Usage = (Operation == FETCH) ? &Instr_Usage : &Data_Usage;
+        Usage->Split_Access++;
+        while (Size > 0)
+        {
+            Next_Line = (address | BYTE_MASK) + 1;
+            if (Next_Line - address >= Size)
+            {
+                Simulate_Line_Access(Operation, address, Size);
+                break;
+            }
+            Simulate_Line_Access(Operation, address, Next_Line - address);
+            Size -= Next_Line - address;
+            address = Next_Line;
+        }
+    }
+    else Simulate_Line_Access(Operation, address, Size);
+}
+
+/* Logging is a compile-time constant of the core, so the logging-off variant has no
+*  Mode/event log test on the access path
+*/
+ALWAYS_INLINE void Simulate_Line_Access_Core(unsigned int Operation, Address_Typedef address, uint32_t Size, const bool Logging)
+{
+    bool Error;
+    Address_Typedef Trace_Address = address;
+
+    if (TLB_Config.Enable) address = Translate_Address(address, Operation == FETCH);
+    switch (Operation)
+    {
+    case READ:
+        Error = Data_Cache_Read(address);
+        if (Timing_Config.Enable) Timing_Model_Access(&Data_MSHR, address);
+        break;
+
+    case WRITE:
+        Error = Data_Cache_Write(address);
+        if (Timing_Config.Enable) Timing_Model_Access(&Data_MSHR, address);
+        break;
+
+    default:
+        Error = Instruction_Cache_Fetch(address);
+        if (Timing_Config.Enable) Timing_Model_Access(&Instr_MSHR, address);
+        break;
+    }
+    //Messages between L1 and L2: text in Mode 1, binary records with --event-log
+    if (Logging && (Error == false)) Log_Cache_Event(Operation, address);
+    if (Three_C_Enable && (Error == false)) Miss_Class_Access(Operation, address);
+    if (Heat_Enable && (Error == false)) Set_Heat_Access(Operation, address);
+    if ((Heavy_Hitters > 0) && (Error == false) && (Operation != FETCH)) Heavy_Hitters_Access(address);
+    if ((Region_File != NULL) && (Error == false)) Region_Access(Operation, Trace_Address);
+    if ((Interval.Length > 0) && (Error == false)) Interval_Access();
+    if ((Convergence.Tolerance > 0.0) && (Error == false)) Convergence_Access();
+    if (Reuse_Enable && (Error == false)) Reuse_Access((Operation == FETCH) ? &Instr_Reuse : &Data_Reuse, address >> BYTE_BIT);
+    if (Usage_Enable) Byte_Usage_Access(Operation, address, Size);
+}
+
+void Simulate_Line_Access_Quiet(unsigned int Operation, Address_Typedef address, uint32_t Size)
+{
+    Simulate_Line_Access_Core(Operation, address, Size, false);
+}
+
+void Simulate_Line_Access_Logged(unsigned int Operation, Address_Typedef address, uint32_t Size)
+{
+    Simulate_Line_Access_Core(Operation, address, Size, true);
+}
+
+void Select_Access_Path()
+{
+    Simulate_Line_Access = ((Mode > 0) || (Event_Log.File != NULL)) ? Simulate_Line_Access_Logged : Simulate_Line_Access_Quiet;
+}
+
+//Cache operations
+bool Data_Cache_Read(Address_Typedef address)
+{
+    Tag_Typedef Tag = address >> (SET_BIT + BYTE_BIT);
+    Set_Typedef Set = (address & SET_MASK) >> BYTE_BIT;
+    int Selected_Cache_Way = -1;
+    uint8_t Empty_Flag = 0;
+
+    Data_Set_Refresh(Set);
+    Data_Stats_Report.Data_Read_Access++;
+    Set_Bitmap_Fill(Data_Valid_Sets, Data_Changed_Sets, Set);
+    Selected_Cache_Way = Data_Match_Find(Tag, Set);        
+    if (Selected_Cache_Way > -1)
+    {
+        if (Data_Cache[Selected_Cache_Way][Set].Valid)
+        {
+            Data_Stats_Report.Data_Hit++;
+            Access_Result.Outcome = ACCESS_HIT;
+            Data_Cache[Selected_Cache_Way][Set].tag = Tag;
+            Data_Cache[Selected_Cache_Way][Set].set = Set;
+            Data_Cache[Selected_Cache_Way][Set].Valid = Data_Cache[Selected_Cache_Way][Set].Valid;
+            Data_Cache[Selected_Cache_Way][Set].Dirty = Data_Cache[Selected_Cache_Way][Set].Dirty;
+            Data_Cache[Selected_Cache_Way][Set].address = address;
+            Data_LRU_State_Update(Selected_Cache_Way, Set, Empty_Flag);
+        }        
+        else
         {
-            if (Mode > 0) printf("\033[33;4m[READ_ ACCESS %6u] L1(DATA)  READ MISS  - Read from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Read_Access, address);            
             Data_Stats_Report.Data_Miss++;
+            Access_Result.Outcome = ACCESS_MISS;
             Data_Cache[Selected_Cache_Way][Set].tag = Tag;
             Data_Cache[Selected_Cache_Way][Set].set = Set;
             Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -328,7 +2138,8 @@ bool Data_Cache_Read(unsigned int address)
     else
     {        
         Data_Stats_Report.Data_Miss++;
-        uint16_t Tag_Mask = pow(2, TAG_BIT);
+        Access_Result.Outcome = ACCESS_MISS;
+        Tag_Typedef Tag_Mask = EMPTY_TAG;
         for (uint8_t i = 0; (Selected_Cache_Way<0) && (i < DATA_WAYS); i++)
         {            
             if (Data_Cache[i][Set].tag == Tag_Mask)
@@ -339,10 +2150,6 @@ bool Data_Cache_Read(unsigned int address)
         }
         if (Selected_Cache_Way > -1)
         {
-            if (Mode > 0)
-            {
-                printf("\033[33;4m[READ_ ACCESS %6u] L1(DATA)  READ MISS  - Read from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Read_Access, address);
-            }   
             Data_Cache[Selected_Cache_Way][Set].tag = Tag;
             Data_Cache[Selected_Cache_Way][Set].set = Set;
             Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -366,10 +2173,8 @@ bool Data_Cache_Read(unsigned int address)
                 {
                     if (0 == Data_Cache[Selected_Cache_Way][Set].Dirty)
                     {                      
-                        if (Mode > 0)
-                        {                            
-                            printf("\033[33;4m[READ_ ACCESS %6u] L1(DATA)  READ MISS  - L1 evict <0x%08x> - Read from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Read_Access, Data_Cache[Selected_Cache_Way][Set].address, address);              
-                        }
+                        Access_Result.Outcome = ACCESS_MISS_EVICT;
+                        Access_Result.Victim_Address = Data_Cache[Selected_Cache_Way][Set].address;
                         Data_Cache[Selected_Cache_Way][Set].tag = Tag;
                         Data_Cache[Selected_Cache_Way][Set].set = Set;
                         Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -379,8 +2184,9 @@ bool Data_Cache_Read(unsigned int address)
                     }
                     else
                     {                        
-                        if (Mode > 0) printf("\033[33;4m[READ_ ACCESS %6u] L1(DATA)  READ MISS  - Write to L2 <0x%08x> - Read from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Read_Access, Data_Cache[Selected_Cache_Way][Set].address, address);                                    
-                        Data_Stats_Report.Write_Back++;                        
+                        Data_Stats_Report.Write_Back++;
+                        Access_Result.Outcome = ACCESS_MISS_WRITE_BACK;
+                        Access_Result.Victim_Address = Data_Cache[Selected_Cache_Way][Set].address;                        
                         Data_Cache[Selected_Cache_Way][Set].tag = Tag;
                         Data_Cache[Selected_Cache_Way][Set].set = Set;
                         Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -397,7 +2203,8 @@ bool Data_Cache_Read(unsigned int address)
             }
             else
             {
-                if (Mode > 0) printf("\033[33;4m[READ_ ACCESS %6u] L1(DATA)  READ MISS  - L1 evict <0x%08x> - Read from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Read_Access, Data_Cache[Selected_Cache_Way][Set].address, address);                
+                Access_Result.Outcome = ACCESS_MISS_REPLACE;
+                Access_Result.Victim_Address = Data_Cache[Selected_Cache_Way][Set].address;
                 Data_Cache[Selected_Cache_Way][Set].tag = Tag;
                 Data_Cache[Selected_Cache_Way][Set].set = Set;
                 Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -410,32 +2217,34 @@ bool Data_Cache_Read(unsigned int address)
     return false;
 }
 
-bool Data_Cache_Write(unsigned int address)
+bool Data_Cache_Write(Address_Typedef address)
 {
-    uint16_t Tag = address >> (SET_BIT + BYTE_BIT);
-    uint16_t Set = (address & SET_MASK) >> BYTE_BIT;
+    Tag_Typedef Tag = address >> (SET_BIT + BYTE_BIT);
+    Set_Typedef Set = (address & SET_MASK) >> BYTE_BIT;
     int Selected_Cache_Way = -1;
     uint8_t Empty_Flag = 0;
 
+    Data_Set_Refresh(Set);
     Data_Stats_Report.Data_Write_Access++;
+    Set_Bitmap_Fill(Data_Valid_Sets, Data_Changed_Sets, Set);
     Selected_Cache_Way = Data_Match_Find(Tag, Set);        
     if (Selected_Cache_Way > -1)
     {
         if (Data_Cache[Selected_Cache_Way][Set].Valid == 1)
         {
             Data_Stats_Report.Data_Hit++;
+            Access_Result.Outcome = ACCESS_HIT;
             Data_Cache[Selected_Cache_Way][Set].tag = Tag;
             Data_Cache[Selected_Cache_Way][Set].set = Set;
             Data_Cache[Selected_Cache_Way][Set].Valid = Data_Cache[Selected_Cache_Way][Set].Valid;
             Data_Cache[Selected_Cache_Way][Set].Dirty = 1;
             Data_Cache[Selected_Cache_Way][Set].address = address;
             Data_LRU_State_Update(Selected_Cache_Way, Set, Empty_Flag);
-            if ((Mode > 0) && (Hit_Show == 1)) printf("\033[33m[WRITE ACCESS %6u] L1(DATA)  WRITE HIT <0x%08x>\033[0m\n", Data_Stats_Report.Data_Write_Access, address);            
         }
         else
         {
-            if (Mode > 0) printf("\033[33;4m[WRITE ACCESS %6u] L1(DATA)  WRITE MISS - Read for Ownership from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Write_Access, address);            
             Data_Stats_Report.Data_Miss++;
+            Access_Result.Outcome = ACCESS_MISS;
             Data_Cache[Selected_Cache_Way][Set].tag = Tag;
             Data_Cache[Selected_Cache_Way][Set].set = Set;
             Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -447,7 +2256,8 @@ bool Data_Cache_Write(unsigned int address)
     else
     {
         Data_Stats_Report.Data_Miss++;
-        uint16_t Tag_Mask = pow(2, TAG_BIT);
+        Access_Result.Outcome = ACCESS_MISS;
+        Tag_Typedef Tag_Mask = EMPTY_TAG;
 
         for (uint8_t i = 0; (Selected_Cache_Way<0) && (i < DATA_WAYS); i++)
         {            
@@ -459,10 +2269,6 @@ bool Data_Cache_Write(unsigned int address)
         }
         if (Selected_Cache_Way > -1)
         {
-            if (Mode > 0)
-            {
-                printf("\033[33;4m[WRITE ACCESS %6u] L1(DATA)  WRITE MISS - Read for Ownership from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Write_Access, address);          
-            }
             Data_Cache[Selected_Cache_Way][Set].tag = Tag;
             Data_Cache[Selected_Cache_Way][Set].set = Set;
             Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -487,7 +2293,8 @@ bool Data_Cache_Write(unsigned int address)
                 {
                     if (0 == Data_Cache[Selected_Cache_Way][Set].Dirty)
                     {                 
-                        if (Mode > 0) printf("\033[33;4m[WRITE ACCESS %6u] L1(DATA)  WRITE MISS - L1 evict <0x%08x> - Read for Ownership from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Write_Access, Data_Cache[Selected_Cache_Way][Set].address, address);                                                        
+                        Access_Result.Outcome = ACCESS_MISS_EVICT;
+                        Access_Result.Victim_Address = Data_Cache[Selected_Cache_Way][Set].address;
                         Data_Cache[Selected_Cache_Way][Set].tag = Tag;
                         Data_Cache[Selected_Cache_Way][Set].set = Set;
                         Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -497,8 +2304,9 @@ bool Data_Cache_Write(unsigned int address)
                     }
                     else
                     {
-                        if (Mode > 0) printf("\033[33;4m[WRITE ACCESS %6u] L1(DATA)  WRITE MISS - Write to L2 <0x%08x> - Read for Ownership from L2 <0x%08x>\033[0m\n", Data_Stats_Report.Data_Write_Access, Data_Cache[Selected_Cache_Way][Set].address, address);                                                            
                         Data_Stats_Report.Write_Back++;
+                        Access_Result.Outcome = ACCESS_MISS_WRITE_BACK;
+                        Access_Result.Victim_Address = Data_Cache[Selected_Cache_Way][Set].address;
                         Data_Cache[Selected_Cache_Way][Set].tag = Tag;
                         Data_Cache[Selected_Cache_Way][Set].set = Set;
                         Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -515,7 +2323,8 @@ bool Data_Cache_Write(unsigned int address)
             }
             else
             {
-                if (Mode > 0) printf("\033[33;4m[WRITE ACCESS %6u] L1(DATA)  WRITE MISS - L1 evict <0x%08x> - Read for Ownership from L2 <0x%08x>)\033[0m\n", Data_Stats_Report.Data_Write_Access, Data_Cache[Selected_Cache_Way][Set].address, address);                
+                Access_Result.Outcome = ACCESS_MISS_REPLACE;
+                Access_Result.Victim_Address = Data_Cache[Selected_Cache_Way][Set].address;
                 Data_Cache[Selected_Cache_Way][Set].tag = Tag;
                 Data_Cache[Selected_Cache_Way][Set].set = Set;
                 Data_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -528,32 +2337,34 @@ bool Data_Cache_Write(unsigned int address)
     return false;
 }
 
-bool Instruction_Cache_Fetch(unsigned int address)
+bool Instruction_Cache_Fetch(Address_Typedef address)
 {
-    uint16_t Tag = address >> (SET_BIT + BYTE_BIT);
-    uint16_t Set = (address & SET_MASK) >> BYTE_BIT;
+    Tag_Typedef Tag = address >> (SET_BIT + BYTE_BIT);
+    Set_Typedef Set = (address & SET_MASK) >> BYTE_BIT;
     int Selected_Cache_Way = -1;
     uint8_t Empty_Flag = 0;
 
+    Instruction_Set_Refresh(Set);
     Instr_Stats_Report.Instruction_Read_Access++;
+    Set_Bitmap_Fill(Instr_Valid_Sets, Instr_Changed_Sets, Set);
     Selected_Cache_Way = Instruction_Match_Find(Tag, Set);
     if (Selected_Cache_Way > -1)
     {
         if (Instr_Cache[Selected_Cache_Way][Set].Valid)
         {
             Instr_Stats_Report.Instruction_Hit++;
+            Access_Result.Outcome = ACCESS_HIT;
             Instr_Cache[Selected_Cache_Way][Set].tag = Tag;
             Instr_Cache[Selected_Cache_Way][Set].set = Set;
             Instr_Cache[Selected_Cache_Way][Set].Valid = Instr_Cache[Selected_Cache_Way][Set].Valid;
             Instr_Cache[Selected_Cache_Way][Set].Dirty = Instr_Cache[Selected_Cache_Way][Set].Dirty;
             Instr_Cache[Selected_Cache_Way][Set].address = address;
             Instruction_LRU_State_Update(Selected_Cache_Way, Set, Empty_Flag);
-            if ((Mode > 0) && (Hit_Show == 1)) printf("\033[33m[READ_ ACCESS %6u] L1(INSTR) READ HIT <0x%08x>\033[0m\n",  Instr_Stats_Report.Instruction_Read_Access, address);
         }
         else
         {
-            if (Mode > 0) printf("\033[33;4m[READ_ ACCESS %6u] L1(INSTR) READ MISS  - Read from L2 <0x%08x>\033[0m\n", Instr_Stats_Report.Instruction_Read_Access, address);            
             Instr_Stats_Report.Instruction_Miss++;
+            Access_Result.Outcome = ACCESS_MISS;
             Instr_Cache[Selected_Cache_Way][Set].tag = Tag;
             Instr_Cache[Selected_Cache_Way][Set].set = Set;
             Instr_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -565,7 +2376,8 @@ bool Instruction_Cache_Fetch(unsigned int address)
     else
     {
         Instr_Stats_Report.Instruction_Miss++;
-        uint16_t Tag_Mask = pow(2, TAG_BIT);
+        Access_Result.Outcome = ACCESS_MISS;
+        Tag_Typedef Tag_Mask = EMPTY_TAG;
         for (uint8_t i = 0; (Selected_Cache_Way<0) && (i < INSTR_WAYS); i++)
         {            
             if (Instr_Cache[i][Set].tag == Tag_Mask)
@@ -576,7 +2388,6 @@ bool Instruction_Cache_Fetch(unsigned int address)
         }
         if (Selected_Cache_Way > -1)
         {
-            if (Mode >= 1) printf("\033[33;4m[READ_ ACCESS %6u] L1(INSTR) READ MISS  - Read from L2 <0x%08x>\033[0m\n", Instr_Stats_Report.Instruction_Read_Access, address);              
             Instr_Cache[Selected_Cache_Way][Set].tag = Tag;
             Instr_Cache[Selected_Cache_Way][Set].set = Set;
             Instr_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -597,7 +2408,8 @@ bool Instruction_Cache_Fetch(unsigned int address)
                 {
                     if (0 == Instr_Cache[Selected_Cache_Way][Set].Dirty)
                     {
-                        if (Mode > 0) printf("\033[33;4m[READ_ ACCESS %6u] L1(INSTR) READ MISS  - L1 evict <0x%08x> - Read from L2 <0x%08x>\033[0m\n", Instr_Stats_Report.Instruction_Read_Access, Instr_Cache[Selected_Cache_Way][Set].address, address);                                                    
+                        Access_Result.Outcome = ACCESS_MISS_EVICT;
+                        Access_Result.Victim_Address = Instr_Cache[Selected_Cache_Way][Set].address;
                         Instr_Cache[Selected_Cache_Way][Set].tag = Tag;
                         Instr_Cache[Selected_Cache_Way][Set].set = Set;
                         Instr_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -615,7 +2427,8 @@ bool Instruction_Cache_Fetch(unsigned int address)
             }
             else
             {
-                if (Mode > 0) printf("\033[33;4m[READ_ ACCESS %6u] L1(INSTR) READ MISS  - L1 evict <0x%08x> - Read from L2 <0x%08x>\033[0m\n", Instr_Stats_Report.Instruction_Read_Access, Instr_Cache[Selected_Cache_Way][Set].address, address);                
+                Access_Result.Outcome = ACCESS_MISS_REPLACE;
+                Access_Result.Victim_Address = Instr_Cache[Selected_Cache_Way][Set].address;
                 Instr_Cache[Selected_Cache_Way][Set].tag = Tag;
                 Instr_Cache[Selected_Cache_Way][Set].set = Set;
                 Instr_Cache[Selected_Cache_Way][Set].Valid = 1;
@@ -628,13 +2441,16 @@ bool Instruction_Cache_Fetch(unsigned int address)
     return false;
 }
 
-bool L2_Evict_Command_to_L1(unsigned int address)
+bool L2_Evict_Command_to_L1(Address_Typedef address)
 {
-    uint16_t Tag = address >> (SET_BIT + BYTE_BIT);
-    uint16_t Set = (address & SET_MASK) >> BYTE_BIT;
+    Tag_Typedef Tag = address >> (SET_BIT + BYTE_BIT);
+    Set_Typedef Set = (address & SET_MASK) >> BYTE_BIT;
     bool Match_Line = false;
     bool Search_Instructions = false;
 
+    Data_Set_Refresh(Set);
+    Instruction_Set_Refresh(Set);
+    Access_Result.Outcome = ACCESS_INVALIDATE;
     for (uint8_t i = 0; i < DATA_WAYS; i++)
     {
         if (Data_Cache[i][Set].tag == Tag)
@@ -651,7 +2467,8 @@ bool L2_Evict_Command_to_L1(unsigned int address)
                 }
                 else
                 {
-                    if (Mode > 0) printf("\033[33;4mEVICTION FROM L2 - Write to L2 <0x%08x>\033[0m\n", address);                    
+                    Access_Result.Outcome = ACCESS_INVALIDATE_WRITE_BACK;
+                    Access_Result.Victim_Address = Data_Cache[i][Set].address;
                     Data_Cache[i][Set].tag = Tag;
                     Data_Cache[i][Set].set = Set;
                     Data_Cache[i][Set].Valid = 0;
@@ -696,66 +2513,41 @@ bool L2_Evict_Command_to_L1(unsigned int address)
                 if ((i >= 1) && (Match_Line == false))
                 {
                     printf("ERROR: LINE NOT FOUND IN L1!\n");
+                    Set_Bitmap_Invalidate(Set);
                     return true;
                 }
                 
             }                        
         }        
     }
+    Set_Bitmap_Invalidate(Set);
     return false;    
 }
 
 bool Print_Content_And_State()
 {
-    uint8_t Valid_in_Set = 0;
-    uint16_t Sets_Number = pow(2, SET_BIT);
-
-    Data_Stats_Report.Data_Hit_Ratio = (float)((Data_Stats_Report.Data_Hit*1.0)/(Data_Stats_Report.Data_Miss + Data_Stats_Report.Data_Hit));
-    Instr_Stats_Report.Instr_Hit_Ratio = (float)((Instr_Stats_Report.Instruction_Hit*1.0)/(Instr_Stats_Report.Instruction_Miss + Instr_Stats_Report.Instruction_Hit));    
+    PROFILE_SCOPE(PROFILE_REPORT);
+    Data_Stats_Report.Data_Hit_Ratio = (Data_Stats_Report.Data_Hit*1.0)/(Data_Stats_Report.Data_Miss + Data_Stats_Report.Data_Hit);
+    Instr_Stats_Report.Instr_Hit_Ratio = (Instr_Stats_Report.Instruction_Hit*1.0)/(Instr_Stats_Report.Instruction_Miss + Instr_Stats_Report.Instruction_Hit);    
+    Export_Stats_Snapshot("print_log");
+    if (Quiet) return false;
+    if (Host_Perf.Enable) Host_Perf_Report_Begin();
+    //Messages still in the ring come before the report
+    Async_Log_Drain();
     if (Mode > 0) printf("\033[33m==============================================================================================================\033[0m\n");
     printf("\033[36m==============================================================================================================\033[0m\n");
     printf("\033[36m\t\t\t\t\033[4;1mL1 CACHE SUMMARY AND STATISTICS:\033[0m\n");
     //Data Cache Information
-    printf("\033[36m\033[4;1m1. DATA CACHE CONTENT:\n\033[0m\n");
-    for (uint16_t i = 0; i < Sets_Number; i++)
-    {
-        for (uint8_t j = 0; j < DATA_WAYS; j++)
-        {
-            if (Data_Cache[j][i].Valid == 1)
-            {
-                if (Valid_in_Set == 0)
-                {
-                    printf("\033[36m\033[4mSet Index: %u\033[0m\n", i);
-                    Valid_in_Set = 1;
-                }
-                printf("\033[36mWay Index: %u || Address: 0x%08x || Tag: %04u || Set: %05u || LRU: %1d || Valid: %u || Dirty: %d\033[0m\n", 
-                j, Data_Cache[j][i].address, Data_Cache[j][i].tag, Data_Cache[j][i].set, Data_Cache[j][i].LRU_State, Data_Cache[j][i].Valid, Data_Cache[j][i].Dirty);
-            }            
-        }
-        Valid_in_Set = 0;
-    }
+    printf("\033[36m\033[4;1m1. DATA CACHE CONTENT%s:\n\033[0m\n", Print_Diff ? " (SETS CHANGED SINCE THE LAST LOG)" : "");
+    Print_Cache_Sets(false, Print_Diff ? Data_Changed_Sets : Data_Valid_Sets, Print_Diff);
     printf("\033[36m--------------------------------------------------------------------------------------------------------------\033[0m\n");
 
     //Instruction Cache Informatinon
-    printf("\033[36m\033[4;1m2. INSTRUCTION CACHE CONTENT:\n\033[0m\n");
-    for (uint16_t i = 0; i < Sets_Number; i++)
-    {
-        for (uint8_t j = 0; j < INSTR_WAYS; j++)
-        {
-            if (Instr_Cache[j][i].Valid == 1)
-            {
-                if (Valid_in_Set == 0)
-                {
-                    printf("\033[36m\033[4mSet Index: %u\033[0m\n", i);
-                    Valid_in_Set = 1;
-                }
-                printf("\033[36mWay Index: %u || Address: 0x%08x || Tag: %04u || Set: %05u || LRU: %1d || Valid: %u\033[0m\n", 
-                j, Instr_Cache[j][i].address, Instr_Cache[j][i].tag, Instr_Cache[j][i].set, Instr_Cache[j][i].LRU_State, Instr_Cache[j][i].Valid);
-            }            
-        }
-        Valid_in_Set = 0;
-    }
+    printf("\033[36m\033[4;1m2. INSTRUCTION CACHE CONTENT%s:\n\033[0m\n", Print_Diff ? " (SETS CHANGED SINCE THE LAST LOG)" : "");
+    Print_Cache_Sets(true, Print_Diff ? Instr_Changed_Sets : Instr_Valid_Sets, Print_Diff);
     printf("\033[36m--------------------------------------------------------------------------------------------------------------\033[0m\n");
+    memset(Data_Changed_Sets, 0, sizeof(Data_Changed_Sets));
+    memset(Instr_Changed_Sets, 0, sizeof(Instr_Changed_Sets));
 
     //Statistics
     printf("\033[36m\033[4;1m3. L1 CACHE STATISTICS:\n\033[0m\n");
@@ -766,7 +2558,7 @@ bool Print_Content_And_State()
     }
     else
     {
-        printf("\033[36m\t+Data Cache Read Accesses: %u\n\t+Data Cache Write Accesses: %u\n\t+Data Cache Write Backs: %u\n\t+Data Cache Hits: %u\n\t+Data Cache Misses: %u\n\t+Data Cache Hit Ratio: %1.4f\n\033[0m\n", 
+        printf("\033[36m\t+Data Cache Read Accesses: %" PRIu64 "\n\t+Data Cache Write Accesses: %" PRIu64 "\n\t+Data Cache Write Backs: %" PRIu64 "\n\t+Data Cache Hits: %" PRIu64 "\n\t+Data Cache Misses: %" PRIu64 "\n\t+Data Cache Hit Ratio: %1.4f\n\033[0m\n", 
         Data_Stats_Report.Data_Read_Access, Data_Stats_Report.Data_Write_Access, Data_Stats_Report.Write_Back, Data_Stats_Report.Data_Hit, Data_Stats_Report.Data_Miss, Data_Stats_Report.Data_Hit_Ratio);
     }
     printf("\033[36m\033[1mb. INSTRUCTION CACHE:\033[0m\n");
@@ -776,16 +2568,30 @@ bool Print_Content_And_State()
     }
     else
     {
-        printf("\033[36m\t+Instruction Cache Read Accesses: %u\n\t+Instruction Cache Write Accesses: %u\n\t+Instruction Cache Hits: %u\n\t+Instruction Cache Misses: %u\n\t+Instruction Cache Hit Ratio: %1.4f\n\033[0m\n", 
+        printf("\033[36m\t+Instruction Cache Read Accesses: %" PRIu64 "\n\t+Instruction Cache Write Accesses: %" PRIu64 "\n\t+Instruction Cache Hits: %" PRIu64 "\n\t+Instruction Cache Misses: %" PRIu64 "\n\t+Instruction Cache Hit Ratio: %1.4f\n\033[0m\n", 
         Instr_Stats_Report.Instruction_Read_Access, Instr_Stats_Report.Instruction_Write_Access, Instr_Stats_Report.Instruction_Hit, Instr_Stats_Report.Instruction_Miss, Instr_Stats_Report.Instr_Hit_Ratio);
     }
+    if (Three_C_Enable) Print_Miss_Class_Report();
+    if (Timing_Config.Enable) Print_Timing_Report();
+    if (DRAM_Config.Enable) Print_DRAM_Report();
+    if (TLB_Config.Enable) Print_Translation_Report();
+    if (Usage_Enable) Print_Byte_Usage_Report();
+    if (Reuse_Enable) Print_Reuse_Report();
+    if (Hot_Sets > 0) Print_Hot_Sets_Report();
+    if (Heavy_Hitters > 0) Print_Heavy_Hitters_Report(false);
+    if (Region_File != NULL) Print_Region_Report();
+    if (Interval.Length > 0) Print_Interval_Report();
+    if (Convergence.Tolerance > 0.0) Print_Convergence_Report();
+    if (Host_Perf.Enable) Print_Host_Perf_Report(false);
     printf("\033[36m==============================================================================================================\033[0m\n");
+    if (Host_Perf.Enable) Host_Perf_Report_End();
     return false;
 }
 
 //Support functions
-int Data_Match_Find(unsigned int Input_Tag, unsigned int Input_Set)
+int Data_Match_Find(Tag_Typedef Input_Tag, Set_Typedef Input_Set)
 {        
+    PROFILE_SCOPE(PROFILE_LOOKUP);
     for (uint8_t i = 0; i < DATA_WAYS; i++)
     {
         if (Data_Cache[i][Input_Set].tag == Input_Tag) return i;               
@@ -793,8 +2599,9 @@ int Data_Match_Find(unsigned int Input_Tag, unsigned int Input_Set)
     return -1;
 }
 
-int Instruction_Match_Find(unsigned int Input_Tag, unsigned int Input_Set)
+int Instruction_Match_Find(Tag_Typedef Input_Tag, Set_Typedef Input_Set)
 {
+    PROFILE_SCOPE(PROFILE_LOOKUP);
     for (uint8_t i = 0; i < INSTR_WAYS; i++)
     {
         if (Instr_Cache[i][Input_Set].tag == Input_Tag) return i;                
@@ -804,21 +2611,30 @@ int Instruction_Match_Find(unsigned int Input_Tag, unsigned int Input_Set)
 
 void Data_LRU_State_Update(unsigned int Set_Way, unsigned int Cache_Set, uint8_t Empty_Flag)
 {
+    PROFILE_SCOPE(PROFILE_REPLACEMENT);
     uint8_t LRU_Current_State = Data_Cache[Set_Way][Cache_Set].LRU_State;
     if (0 == Empty_Flag)
     {        
         for (uint8_t i = 0; i < DATA_LRU; i++)
         {
+#ifdef CACHE_DEBUG_CHECKS
             if (LRU_Current_State > Data_Cache[i][Cache_Set].LRU_State) __asm__("nop");
             else --Data_Cache[i][Cache_Set].LRU_State;                       
+#else
+            Data_Cache[i][Cache_Set].LRU_State -= (LRU_Current_State <= Data_Cache[i][Cache_Set].LRU_State);
+#endif
         }        
     }
     else              
     {
         for (uint8_t i = 0; i < Set_Way; i++)
         {
+#ifdef CACHE_DEBUG_CHECKS
             if (Data_Cache[i][Cache_Set].LRU_State < 4) --Data_Cache[i][Cache_Set].LRU_State;
             else printf("\033[1;31mERROR: LRU DATA CORRUPTED\033[1;0m\n");                                     
+#else
+            --Data_Cache[i][Cache_Set].LRU_State;
+#endif
         }        
     }
     Data_Cache[Set_Way][Cache_Set].LRU_State = 3; 
@@ -826,22 +2642,28 @@ void Data_LRU_State_Update(unsigned int Set_Way, unsigned int Cache_Set, uint8_t
 
 void Instruction_LRU_State_Update(unsigned int Set_Way, unsigned int Cache_Set, uint8_t Empty_Flag)
 {
+    PROFILE_SCOPE(PROFILE_REPLACEMENT);
     uint8_t LRU_Current_State = Instr_Cache[Set_Way][Cache_Set].LRU_State;
 
     if (0 == Empty_Flag) 
     {        
         for (uint8_t i = 0; i < INSTR_LRU; i++)
         {
+#ifdef CACHE_DEBUG_CHECKS
             if (LRU_Current_State > Instr_Cache[i][Cache_Set].LRU_State) __asm__("nop");
             else --Instr_Cache[i][Cache_Set].LRU_State;                      
+#else
+            Instr_Cache[i][Cache_Set].LRU_State -= (LRU_Current_State <= Instr_Cache[i][Cache_Set].LRU_State);
+#endif
         }        
     }
     else for (uint8_t i = 0; i < Set_Way; i++) --Instr_Cache[i][Cache_Set].LRU_State;                    
     Instr_Cache[Set_Way][Cache_Set].LRU_State = 1;
 }
 
-int Data_LRU_Smallest_Find(uint16_t Set_Index)
+int Data_LRU_Smallest_Find(Set_Typedef Set_Index)
 {
+    PROFILE_SCOPE(PROFILE_REPLACEMENT);
     for (uint8_t i = 0; i < DATA_WAYS; i++)
     {
         if (Data_Cache[i][Set_Index].LRU_State == 0) return i;               
@@ -849,12 +2671,3641 @@ int Data_LRU_Smallest_Find(uint16_t Set_Index)
     return -1;
 }
 
-int Instruction_LRU_Smallest_Find(uint16_t Set_Index)
+int Instruction_LRU_Smallest_Find(Set_Typedef Set_Index)
 {
+    PROFILE_SCOPE(PROFILE_REPLACEMENT);
     for (uint8_t i = 0; i < INSTR_WAYS; i++)
     {
         if (Instr_Cache[i][Set_Index].LRU_State == 0) return i;              
     }
     return -1;
 }
+ALWAYS_INLINE void Data_Set_Refresh(Set_Typedef Set)
+{
+    if (Data_Set_Epoch[Set] != Data_Epoch) Data_Set_Clear(Set);
+}
+
+ALWAYS_INLINE void Instruction_Set_Refresh(Set_Typedef Set)
+{
+    if (Instr_Set_Epoch[Set] != Instr_Epoch) Instruction_Set_Clear(Set);
+}
+
+void Data_Set_Clear(Set_Typedef Set)
+{
+    Tag_Typedef Tag_Mask = EMPTY_TAG;
+
+    for (uint8_t i = 0; i < DATA_WAYS; i++)
+    {
+        Data_Cache[i][Set].tag = Tag_Mask;
+        Data_Cache[i][Set].set = 0;
+        Data_Cache[i][Set].LRU_State = 0;
+        Data_Cache[i][Set].Valid = 0;
+        Data_Cache[i][Set].Dirty = 0;
+        Data_Cache[i][Set].address = 0;
+        memset(Data_Byte_Used[i][Set], 0, sizeof(Data_Byte_Used[i][Set]));
+    }
+    Data_Set_Epoch[Set] = Data_Epoch;
+}
+
+void Instruction_Set_Clear(Set_Typedef Set)
+{
+    Tag_Typedef Tag_Mask = EMPTY_TAG;
+
+    for (uint8_t i = 0; i < INSTR_WAYS; i++)
+    {
+        Instr_Cache[i][Set].tag = Tag_Mask;
+        Instr_Cache[i][Set].set = 0;
+        Instr_Cache[i][Set].LRU_State = 0;
+        Instr_Cache[i][Set].Valid = 0;
+        Instr_Cache[i][Set].Dirty = 0;
+        Instr_Cache[i][Set].address = 0;
+        memset(Instr_Byte_Used[i][Set], 0, sizeof(Instr_Byte_Used[i][Set]));
+    }
+    Instr_Set_Epoch[Set] = Instr_Epoch;
+}
+
+//Set bitmaps
+void Set_Bitmap_Fill(uint64_t* Valid_Sets, uint64_t* Changed_Sets, Set_Typedef Set)
+{
+    //Every access leaves a valid line in its set, and may change the LRU state or address shown
+    Valid_Sets[Set >> 6] |= 1ULL << (Set & 63);
+    Changed_Sets[Set >> 6] |= 1ULL << (Set & 63);
+}
+
+void Set_Bitmap_Invalidate(Set_Typedef Set)
+{
+    bool Data_Valid = false;
+    bool Instr_Valid = false;
+
+    for (uint8_t i = 0; i < DATA_WAYS; i++) Data_Valid = Data_Valid || Data_Cache[i][Set].Valid;
+    for (uint8_t i = 0; i < INSTR_WAYS; i++) Instr_Valid = Instr_Valid || Instr_Cache[i][Set].Valid;
+    //Only a cache that had valid lines in the set can show a change
+    Data_Changed_Sets[Set >> 6] |= Data_Valid_Sets[Set >> 6] & (1ULL << (Set & 63));
+    Instr_Changed_Sets[Set >> 6] |= Instr_Valid_Sets[Set >> 6] & (1ULL << (Set & 63));
+    if (Data_Valid == false) Data_Valid_Sets[Set >> 6] &= ~(1ULL << (Set & 63));
+    if (Instr_Valid == false) Instr_Valid_Sets[Set >> 6] &= ~(1ULL << (Set & 63));
+}
+
+void Set_Bitmap_Reset()
+{
+    for (uint32_t i = 0; i < SET_WORDS; i++)
+    {
+        Data_Changed_Sets[i] |= Data_Valid_Sets[i];
+        Instr_Changed_Sets[i] |= Instr_Valid_Sets[i];
+        Data_Valid_Sets[i] = 0;
+        Instr_Valid_Sets[i] = 0;
+    }
+}
+
+void Print_Cache_Sets(bool Instruction, const uint64_t* Sets, bool Diff)
+{
+    uint8_t Valid_in_Set = 0;
+    uint64_t Word;
+    uint32_t i;
+
+    //Only the sets flagged in the bitmap are visited, lowest set first
+    for (uint32_t w = 0; w < SET_WORDS; w++)
+    {
+        for (Word = Sets[w]; Word != 0; Word &= Word - 1)
+        {
+            i = (w << 6) + __builtin_ctzll(Word);
+            if (Instruction) Instruction_Set_Refresh(i);
+            else Data_Set_Refresh(i);
+            for (uint8_t j = 0; j < (Instruction ? INSTR_WAYS : DATA_WAYS); j++)
+            {
+                if ((Instruction ? Instr_Cache[j][i].Valid : Data_Cache[j][i].Valid) == 1)
+                {
+                    if (Valid_in_Set == 0)
+                    {
+                        printf("\033[36m\033[4mSet Index: %u\033[0m\n", i);
+                        Valid_in_Set = 1;
+                    }
+                    if (Instruction)
+                    {
+                        printf("\033[36mWay Index: %u || Address: 0x" ADDR_FMT " || Tag: " TAG_FMT " || Set: %05u || LRU: %1d || Valid: %u\033[0m\n", 
+                        j, Instr_Cache[j][i].address, Instr_Cache[j][i].tag, Instr_Cache[j][i].set, Instr_Cache[j][i].LRU_State, Instr_Cache[j][i].Valid);
+                    }
+                    else
+                    {
+                        printf("\033[36mWay Index: %u || Address: 0x" ADDR_FMT " || Tag: " TAG_FMT " || Set: %05u || LRU: %1d || Valid: %u || Dirty: %d\033[0m\n", 
+                        j, Data_Cache[j][i].address, Data_Cache[j][i].tag, Data_Cache[j][i].set, Data_Cache[j][i].LRU_State, Data_Cache[j][i].Valid, Data_Cache[j][i].Dirty);
+                    }
+                }
+            }
+            //A changed set left without valid lines was invalidated or cleared
+            if (Diff && (Valid_in_Set == 0)) printf("\033[36m\033[4mSet Index: %u\033[0m\033[36m (no valid line)\033[0m\n", i);
+            Valid_in_Set = 0;
+        }
+    }
+}
+
+char* Option_Value(char* Option, const char* Name)
+{
+    size_t Length = strlen(Name);
+
+    if ((strncmp(Option, Name, Length) == 0) && (Option[Length] == '=')) return &Option[Length + 1];
+    return NULL;
+}
+
+//Hash map
+uint64_t Hash_Line(uint64_t Key)
+{
+    Key ^= Key >> 33;
+    Key *= 0xff51afd7ed558ccdULL;
+    Key ^= Key >> 33;
+    Key *= 0xc4ceb9fe1a85ec53ULL;
+    Key ^= Key >> 33;
+    return Key;
+}
+
+bool Hash_Map_Init(Hash_Map_Typedef* Map, uint64_t Capacity)
+{
+    uint64_t Size = 16;
+
+    while (Size < Capacity) Size <<= 1;
+    Map->Slot = (Hash_Slot_Typedef*) calloc(Size, sizeof(Hash_Slot_Typedef));
+    Map->Generation = 1;
+    Map->Capacity = Size;
+    Map->Count = 0;
+    return Map->Slot != NULL;
+}
+
+bool Hash_Map_Find(Hash_Map_Typedef* Map, uint64_t Key, uint64_t* Value)
+{
+    uint64_t Mask = Map->Capacity - 1;
+    uint64_t Slot = Hash_Line(Key) & Mask;
+
+    while (Map->Slot[Slot].Stamp == Map->Generation)
+    {
+        if (Map->Slot[Slot].Key == Key)
+        {
+            if (Value != NULL) *Value = Map->Slot[Slot].Value;
+            return true;
+        }
+        Slot = (Slot + 1) & Mask;
+    }
+    return false;
+}
+
+bool Hash_Map_Insert(Hash_Map_Typedef* Map, uint64_t Key, uint64_t Value)
+{
+    uint64_t Mask;
+    uint64_t Slot;
+
+    //Keep the load factor under 1/2
+    if ((Map->Count + 1) * 2 > Map->Capacity)
+    {
+        Hash_Map_Typedef Bigger;
+        if (Hash_Map_Init(&Bigger, Map->Capacity * 2) == false) return false;
+        for (uint64_t i = 0; i < Map->Capacity; i++)
+        {
+            if (Map->Slot[i].Stamp == Map->Generation) Hash_Map_Insert(&Bigger, Map->Slot[i].Key, Map->Slot[i].Value);
+        }
+        free(Map->Slot);
+        *Map = Bigger;
+    }
+    Mask = Map->Capacity - 1;
+    Slot = Hash_Line(Key) & Mask;
+    while (Map->Slot[Slot].Stamp == Map->Generation)
+    {
+        if (Map->Slot[Slot].Key == Key)
+        {
+            Map->Slot[Slot].Value = Value;
+            return true;
+        }
+        Slot = (Slot + 1) & Mask;
+    }
+    Map->Slot[Slot].Key = Key;
+    Map->Slot[Slot].Value = Value;
+    Map->Slot[Slot].Stamp = Map->Generation;
+    Map->Count++;
+    return true;
+}
+
+bool Hash_Map_Remove(Hash_Map_Typedef* Map, uint64_t Key)
+{
+    uint64_t Mask = Map->Capacity - 1;
+    uint64_t Slot = Hash_Line(Key) & Mask;
+    uint64_t Next;
+    uint64_t Home;
+
+    while (Map->Slot[Slot].Stamp == Map->Generation)
+    {
+        if (Map->Slot[Slot].Key == Key) break;
+        Slot = (Slot + 1) & Mask;
+    }
+    if (Map->Slot[Slot].Stamp != Map->Generation) return false;
+    //Backward shift deletion: pull later entries of the probe chain into the hole
+    Next = Slot;
+    while (true)
+    {
+        Next = (Next + 1) & Mask;
+        if (Map->Slot[Next].Stamp != Map->Generation) break;
+        Home = Hash_Line(Map->Slot[Next].Key) & Mask;
+        if (((Next > Slot) && ((Home <= Slot) || (Home > Next))) || ((Next < Slot) && (Home <= Slot) && (Home > Next)))
+        {
+            Map->Slot[Slot].Key = Map->Slot[Next].Key;
+            Map->Slot[Slot].Value = Map->Slot[Next].Value;
+            Slot = Next;
+        }
+    }
+    Map->Slot[Slot].Stamp = 0;
+    Map->Count--;
+    return true;
+}
+
+void Hash_Map_Release(Hash_Map_Typedef* Map)
+{
+    free(Map->Slot);
+    Map->Slot = NULL;
+}
+
+void Hash_Map_Clear(Hash_Map_Typedef* Map)
+{
+    Map->Count = 0;
+    if (++Map->Generation == 0)
+    {
+        for (uint64_t i = 0; i < Map->Capacity; i++) Map->Slot[i].Stamp = 0;
+        Map->Generation = 1;
+    }
+}
+
+//Timing model
+void Timing_Model_Reset()
+{
+    memset(&Data_MSHR, 0, sizeof(MSHR_File_Typedef));
+    memset(&Instr_MSHR, 0, sizeof(MSHR_File_Typedef));
+    Sim_Cycle = 0;
+    DRAM_Reset();
+}
+
+void Timing_Model_Advance(MSHR_File_Typedef* MSHR, uint64_t Target)
+{
+    uint64_t Elapsed;
+    int Earliest;
+
+    //Retire fills in completion order while accounting the occupancy of each interval
+    while (MSHR->Last_Cycle < Target)
+    {
+        Earliest = -1;
+        for (uint32_t i = 0; i < MSHR->Used; i++)
+        {
+            if ((MSHR->Ready[i] <= Target) && ((Earliest < 0) || (MSHR->Ready[i] < MSHR->Ready[Earliest]))) Earliest = i;
+        }
+        Elapsed = ((Earliest < 0) ? Target : MSHR->Ready[Earliest]) - MSHR->Last_Cycle;
+        MSHR->Occupancy[MSHR->Used] += Elapsed;
+        MSHR->Occupancy_Sum += Elapsed * MSHR->Used;
+        if (MSHR->Used > 0) MSHR->Busy_Cycles += Elapsed;
+        MSHR->Last_Cycle += Elapsed;
+        if (Earliest > -1)
+        {
+            MSHR->Used--;
+            MSHR->Line[Earliest] = MSHR->Line[MSHR->Used];
+            MSHR->Ready[Earliest] = MSHR->Ready[MSHR->Used];
+        }
+    }
+    //Fills returning exactly at the target cycle
+    for (uint32_t i = 0; i < MSHR->Used; )
+    {
+        if (MSHR->Ready[i] <= Target)
+        {
+            MSHR->Used--;
+            MSHR->Line[i] = MSHR->Line[MSHR->Used];
+            MSHR->Ready[i] = MSHR->Ready[MSHR->Used];
+        }
+        else i++;
+    }
+}
+
+void Timing_Model_Access(MSHR_File_Typedef* MSHR, Address_Typedef address)
+{
+    uint64_t Line = address >> BYTE_BIT;
+    uint64_t Latency = Timing_Config.Hit_Latency;
+    uint64_t Stall = 0;
+
+    //L2 TLB hits and page walks delay the access before the cache lookup
+    if (TLB_Config.Enable) Latency += Translation.Last_Latency;
+    int Entry = -1;
+
+    Timing_Model_Advance(&Data_MSHR, Sim_Cycle);
+    Timing_Model_Advance(&Instr_MSHR, Sim_Cycle);
+    for (uint32_t i = 0; (Entry < 0) && (i < MSHR->Used); i++)
+    {
+        if (MSHR->Line[i] == Line) Entry = i;
+    }
+    if (Entry > -1)
+    {
+        //Secondary miss: the line is already on its way, wait for the same fill
+        MSHR->Merged_Miss++;
+        if (MSHR->Ready[Entry] - Sim_Cycle > Latency) Latency = MSHR->Ready[Entry] - Sim_Cycle;
+    }
+    else if (Access_Result.Outcome != ACCESS_HIT)
+    {
+        if (MSHR->Used >= Timing_Config.MSHR_Entries)
+        {
+            //Every MSHR is busy: stall until the earliest fill returns
+            uint64_t Earliest = MSHR->Ready[0];
+            for (uint32_t i = 1; i < MSHR->Used; i++)
+            {
+                if (MSHR->Ready[i] < Earliest) Earliest = MSHR->Ready[i];
+            }
+            Stall = Earliest - Sim_Cycle;
+            MSHR->Full_Stall++;
+            MSHR->Stall_Cycles += Stall;
+            Sim_Cycle = Earliest;
+            Timing_Model_Advance(&Data_MSHR, Sim_Cycle);
+            Timing_Model_Advance(&Instr_MSHR, Sim_Cycle);
+        }
+        Latency += Timing_Config.L2_Latency;
+        if (Hash_Map_Find(&L2_Lines, Line, NULL) == false)
+        {
+            if (DRAM_Config.Enable) Latency += DRAM_Access(address, false, Sim_Cycle + Latency);
+            else Latency += Timing_Config.Mem_Latency;
+            MSHR->Memory_Fill++;
+            Hash_Map_Insert(&L2_Lines, Line, 0);
+        }
+        MSHR->Line[MSHR->Used] = Line;
+        MSHR->Ready[MSHR->Used] = Sim_Cycle + Latency;
+        MSHR->Used++;
+        MSHR->Primary_Miss++;
+    }
+    //Dirty victims leave through the write buffer without stalling the access
+    if (DRAM_Config.Enable && (Access_Result.Outcome == ACCESS_MISS_WRITE_BACK)) DRAM_Access(Access_Result.Victim_Address, true, Sim_Cycle);
+    MSHR->Accesses++;
+    MSHR->Total_Latency += Stall + Latency;
+    //The trace issues one access per cycle
+    Sim_Cycle++;
+}
+
+void Timing_Model_Evict(Address_Typedef address)
+{
+    Hash_Map_Remove(&L2_Lines, address >> BYTE_BIT);
+    if (DRAM_Config.Enable && (Access_Result.Outcome == ACCESS_INVALIDATE_WRITE_BACK)) DRAM_Access(Access_Result.Victim_Address, true, Sim_Cycle);
+}
+
+void Print_Timing_Report()
+{
+    MSHR_File_Typedef* MSHR[2] = {&Data_MSHR, &Instr_MSHR};
+    const char* Name[2] = {"DATA CACHE", "INSTRUCTION CACHE"};
+    uint64_t Accesses = Data_MSHR.Accesses + Instr_MSHR.Accesses;
+
+    Timing_Model_Advance(&Data_MSHR, Sim_Cycle);
+    Timing_Model_Advance(&Instr_MSHR, Sim_Cycle);
+    printf("\033[36m\033[4;1m4. TIMING MODEL:\n\033[0m\n");
+    printf("\033[36m\t+Cycles: %llu\n\t+Average Memory Access Time: %1.4f cycles\n\033[0m\n", (unsigned long long) Sim_Cycle,
+    (Accesses == 0) ? 0.0 : (double)(Data_MSHR.Total_Latency + Instr_MSHR.Total_Latency) / Accesses);
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        printf("\033[36m\033[1m%c. %s:\033[0m\n", 'a' + i, Name[i]);
+        if (MSHR[i]->Accesses == 0)
+        {
+            printf("\t\033[36mNo operation was executed on this cache!\033[0m\n\n");
+            continue;
+        }
+        printf("\033[36m\t+AMAT: %1.4f cycles\n\t+Primary Misses: %llu (%llu filled from memory)\n\t+Merged Misses: %llu\n\t+MSHR Full Stalls: %llu (%llu cycles)\n\t+Memory-Level Parallelism: %1.4f\n\033[0m",
+        (double) MSHR[i]->Total_Latency / MSHR[i]->Accesses, (unsigned long long) MSHR[i]->Primary_Miss, (unsigned long long) MSHR[i]->Memory_Fill,
+        (unsigned long long) MSHR[i]->Merged_Miss, (unsigned long long) MSHR[i]->Full_Stall, (unsigned long long) MSHR[i]->Stall_Cycles,
+        (MSHR[i]->Busy_Cycles == 0) ? 0.0 : (double) MSHR[i]->Occupancy_Sum / MSHR[i]->Busy_Cycles);
+        printf("\033[36m\t+MSHR Occupancy (busy entries: cycles):\033[0m\n");
+        for (uint32_t j = 0; j <= Timing_Config.MSHR_Entries; j++)
+        {
+            if (MSHR[i]->Occupancy[j] > 0) printf("\033[36m\t   %2u: %llu (%1.2f%%)\033[0m\n", j, (unsigned long long) MSHR[i]->Occupancy[j], (100.0 * MSHR[i]->Occupancy[j]) / MSHR[i]->Last_Cycle);
+        }
+        printf("\n");
+    }
+}
+//DRAM backend
+void DRAM_Reset()
+{
+    memset(&DRAM_State, 0, sizeof(DRAM_State_Typedef));
+    for (uint32_t i = 0; i < MAX_DRAM_BANKS; i++) DRAM_State.Open_Row[i] = -1;
+}
+
+uint64_t DRAM_Access(Address_Typedef address, bool Write, uint64_t Arrival)
+{
+    //Row interleaving: consecutive rows go to consecutive banks
+    uint64_t Row_Index = address / DRAM_Config.Row_Size;
+    uint32_t Bank = Row_Index % DRAM_Config.Banks;
+    int64_t Row = Row_Index / DRAM_Config.Banks;
+    uint64_t Start = (Arrival > DRAM_State.Bank_Ready[Bank]) ? Arrival : DRAM_State.Bank_Ready[Bank];
+    uint64_t Command = DRAM_Config.tCAS;
+    uint64_t Transfer;
+
+    if (DRAM_State.Open_Row[Bank] == Row) DRAM_State.Row_Hit++;
+    else if (DRAM_State.Open_Row[Bank] < 0)
+    {
+        DRAM_State.Row_Empty++;
+        Command += DRAM_Config.tRCD;
+    }
+    else
+    {
+        DRAM_State.Row_Conflict++;
+        Command += DRAM_Config.tRP + DRAM_Config.tRCD;
+    }
+    //Data burst on the shared bus
+    Transfer = ((Start + Command) > DRAM_State.Bus_Ready) ? (Start + Command) : DRAM_State.Bus_Ready;
+    DRAM_State.Bus_Ready = Transfer + DRAM_Config.Burst;
+    DRAM_State.Bus_Busy += DRAM_Config.Burst;
+    if (DRAM_State.Bus_Ready > DRAM_State.Last_Done) DRAM_State.Last_Done = DRAM_State.Bus_Ready;
+    if (DRAM_Config.Policy == OPEN_PAGE)
+    {
+        DRAM_State.Open_Row[Bank] = Row;
+        DRAM_State.Bank_Ready[Bank] = Transfer;
+    }
+    else
+    {
+        DRAM_State.Open_Row[Bank] = -1;
+        DRAM_State.Bank_Ready[Bank] = DRAM_State.Bus_Ready + DRAM_Config.tRP;
+    }
+    if (Write) DRAM_State.Writes++;
+    else
+    {
+        DRAM_State.Reads++;
+        DRAM_State.Read_Latency += DRAM_State.Bus_Ready - Arrival;
+    }
+    return DRAM_State.Bus_Ready - Arrival;
+}
+
+void Print_DRAM_Report()
+{
+    uint64_t Requests = DRAM_State.Reads + DRAM_State.Writes;
+    uint64_t Elapsed = (DRAM_State.Last_Done > Sim_Cycle) ? DRAM_State.Last_Done : Sim_Cycle;
+
+    printf("\033[36m\033[4;1m5. DRAM BACKEND:\n\033[0m\n");
+    if (Requests == 0)
+    {
+        printf("\t\033[36mNo request reached DRAM!\033[0m\n\n");
+        return;
+    }
+    printf("\033[36m\t+Reads (L2 fills): %llu\n\t+Writes (write-backs): %llu\n\t+Row Buffer Hits: %llu\n\t+Row Buffer Misses (closed row): %llu\n\t+Row Buffer Conflicts: %llu\n\t+Row Buffer Hit Rate: %1.4f\n\t+Average Read Latency: %1.4f cycles\n\t+Bus Busy Cycles: %llu\n\t+Bandwidth Utilization: %1.2f%% (%1.4f bytes/cycle)\n\033[0m\n",
+    (unsigned long long) DRAM_State.Reads, (unsigned long long) DRAM_State.Writes, (unsigned long long) DRAM_State.Row_Hit,
+    (unsigned long long) DRAM_State.Row_Empty, (unsigned long long) DRAM_State.Row_Conflict, (double) DRAM_State.Row_Hit / Requests,
+    (DRAM_State.Reads == 0) ? 0.0 : (double) DRAM_State.Read_Latency / DRAM_State.Reads, (unsigned long long) DRAM_State.Bus_Busy,
+    (Elapsed == 0) ? 0.0 : (100.0 * DRAM_State.Bus_Busy) / Elapsed, (Elapsed == 0) ? 0.0 : (double)(Requests << BYTE_BIT) / Elapsed);
+}
+//Address translation
+bool Parse_TLB_Geometry(char* Value, uint32_t* Entries, uint32_t* Ways)
+{
+    char* End = NULL;
+
+    //Format: <entries>:<ways>
+    *Entries = strtoul(Value, &End, 0);
+    *Ways = (*End == ':') ? strtoul(End + 1, NULL, 0) : *Entries;
+    return (*Entries > 0) && (*Ways > 0) && ((*Entries % *Ways) == 0);
+}
+
+bool TLB_Init(TLB_Typedef* TLB, uint32_t Entries, uint32_t Ways)
+{
+    TLB->Ways = Ways;
+    TLB->Sets = Entries / Ways;
+    TLB->VPN = (uint64_t*) malloc(Entries * sizeof(uint64_t));
+    TLB->PFN = (uint64_t*) malloc(Entries * sizeof(uint64_t));
+    TLB->Last_Use = (uint64_t*) malloc(Entries * sizeof(uint64_t));
+    if ((TLB->VPN == NULL) || (TLB->PFN == NULL) || (TLB->Last_Use == NULL)) return false;
+    TLB_Flush(TLB);
+    return true;
+}
+
+void TLB_Flush(TLB_Typedef* TLB)
+{
+    for (uint32_t i = 0; i < TLB->Sets * TLB->Ways; i++)
+    {
+        TLB->VPN[i] = UINT64_MAX;
+        TLB->Last_Use[i] = 0;
+    }
+    TLB->Clock = 0;
+    TLB->Hit = 0;
+    TLB->Miss = 0;
+}
+
+bool TLB_Lookup(TLB_Typedef* TLB, uint64_t VPN, uint64_t* PFN)
+{
+    uint32_t Base = (VPN % TLB->Sets) * TLB->Ways;
+
+    for (uint32_t i = Base; i < Base + TLB->Ways; i++)
+    {
+        if (TLB->VPN[i] == VPN)
+        {
+            TLB->Last_Use[i] = ++TLB->Clock;
+            *PFN = TLB->PFN[i];
+            TLB->Hit++;
+            return true;
+        }
+    }
+    TLB->Miss++;
+    return false;
+}
+
+void TLB_Insert(TLB_Typedef* TLB, uint64_t VPN, uint64_t PFN)
+{
+    uint32_t Base = (VPN % TLB->Sets) * TLB->Ways;
+    uint32_t Victim = Base;
+
+    for (uint32_t i = Base + 1; i < Base + TLB->Ways; i++)
+    {
+        if (TLB->Last_Use[i] < TLB->Last_Use[Victim]) Victim = i;
+    }
+    TLB->VPN[Victim] = VPN;
+    TLB->PFN[Victim] = PFN;
+    TLB->Last_Use[Victim] = ++TLB->Clock;
+}
+
+bool Translation_Init()
+{
+    bool OK = TLB_Init(&ITLB, TLB_Config.ITLB_Entries, TLB_Config.ITLB_Ways)
+           && TLB_Init(&DTLB, TLB_Config.DTLB_Entries, TLB_Config.DTLB_Ways)
+           && TLB_Init(&L2_TLB, TLB_Config.L2_TLB_Entries, TLB_Config.L2_TLB_Ways)
+           && Hash_Map_Init(&Translation.Page_Table, 1 << 12)
+           && Hash_Map_Init(&Translation.Frame_Owner, 1 << 12)
+           && Hash_Map_Init(&Translation.Walk_Lines, 1 << 12);
+
+    //Physical addresses keep the width of the trace addresses
+    Translation.Frames = 1ULL << (ADDRESS_BIT - TLB_Config.Page_Bit);
+    //Pages of the same color map to the same group of L1 sets
+    Translation.Colors = (TLB_Config.Page_Bit < SET_BIT + BYTE_BIT) ? 1u << (SET_BIT + BYTE_BIT - TLB_Config.Page_Bit) : 1;
+    Translation.Next_In_Color = (uint64_t*) calloc(Translation.Colors, sizeof(uint64_t));
+    Translation.Random_State = TLB_Config.Seed | 1;
+    return OK && (Translation.Next_In_Color != NULL);
+}
+
+void Translation_Reset()
+{
+    TLB_Flush(&ITLB);
+    TLB_Flush(&DTLB);
+    TLB_Flush(&L2_TLB);
+    Translation.Walks = 0;
+    Translation.Walk_Latency = 0;
+}
+
+uint64_t Page_Allocate(uint64_t VPN)
+{
+    uint64_t PFN;
+
+    switch (TLB_Config.Allocation)
+    {
+    case ALLOC_RANDOM:
+        //xorshift64, retry while the frame is taken
+        do {
+            Translation.Random_State ^= Translation.Random_State << 13;
+            Translation.Random_State ^= Translation.Random_State >> 7;
+            Translation.Random_State ^= Translation.Random_State << 17;
+            PFN = Translation.Random_State % Translation.Frames;
+        } while ((Translation.Frame_Owner.Count < Translation.Frames) && Hash_Map_Find(&Translation.Frame_Owner, PFN, NULL));
+        break;
+
+    case ALLOC_COLOR:
+        PFN = (Translation.Next_In_Color[VPN % Translation.Colors]++ * Translation.Colors + (VPN % Translation.Colors)) % Translation.Frames;
+        break;
+
+    default:
+        PFN = Translation.Next_Frame++ % Translation.Frames;
+        break;
+    }
+    Hash_Map_Insert(&Translation.Frame_Owner, PFN, VPN);
+    return PFN;
+}
+
+uint64_t Page_Walk(uint64_t VPN)
+{
+    uint64_t PFN;
+    uint64_t Latency = 0;
+    uint32_t Index_Bit = 9; //512 entries per table
+
+    //Each level reads one PTE line: L2 latency if the walker fetched that line before, memory latency otherwise
+    for (uint32_t Level = 0; Level < TLB_Config.Walk_Levels; Level++)
+    {
+        uint64_t Prefix = VPN >> (Index_Bit * (TLB_Config.Walk_Levels - 1 - Level));
+        uint64_t PTE_Line = ((uint64_t) Level << 56) | (Prefix / PTE_PER_LINE);
+        Latency += Timing_Config.L2_Latency;
+        if (Hash_Map_Find(&Translation.Walk_Lines, PTE_Line, NULL) == false)
+        {
+            Latency += Timing_Config.Mem_Latency;
+            Hash_Map_Insert(&Translation.Walk_Lines, PTE_Line, 0);
+        }
+    }
+    if (Hash_Map_Find(&Translation.Page_Table, VPN, &PFN) == false)
+    {
+        PFN = Page_Allocate(VPN);
+        Hash_Map_Insert(&Translation.Page_Table, VPN, PFN);
+    }
+    Translation.Walks++;
+    Translation.Walk_Latency += Latency;
+    Translation.Last_Latency += Latency;
+    return PFN;
+}
+
+Address_Typedef Translate_Address(Address_Typedef address, bool Instruction)
+{
+    uint64_t VPN = address >> TLB_Config.Page_Bit;
+    uint64_t PFN;
+    TLB_Typedef* L1_TLB = Instruction ? &ITLB : &DTLB;
+
+    Translation.Last_Latency = 0;
+    if (TLB_Lookup(L1_TLB, VPN, &PFN) == false)
+    {
+        Translation.Last_Latency = TLB_Config.L2_TLB_Latency;
+        if (TLB_Lookup(&L2_TLB, VPN, &PFN) == false)
+        {
+            PFN = Page_Walk(VPN);
+            TLB_Insert(&L2_TLB, VPN, PFN);
+        }
+        TLB_Insert(L1_TLB, VPN, PFN);
+    }
+    return (Address_Typedef)((PFN << TLB_Config.Page_Bit) | (address & ((1u << TLB_Config.Page_Bit) - 1)));
+}
+
+Address_Typedef Translate_Without_TLB(Address_Typedef address)
+{
+    uint64_t VPN = address >> TLB_Config.Page_Bit;
+    uint64_t PFN;
+
+    //L2 evictions name lines already in the hierarchy: use the page table, not the TLBs
+    if (Hash_Map_Find(&Translation.Page_Table, VPN, &PFN) == false)
+    {
+        PFN = Page_Allocate(VPN);
+        Hash_Map_Insert(&Translation.Page_Table, VPN, PFN);
+    }
+    return (Address_Typedef)((PFN << TLB_Config.Page_Bit) | (address & ((1u << TLB_Config.Page_Bit) - 1)));
+}
+
+//Virtual address of a physical one, through the page last given its frame; unmapped frames are returned as is
+Address_Typedef Translate_Reverse(Address_Typedef address)
+{
+    uint64_t VPN;
+
+    if (Hash_Map_Find(&Translation.Frame_Owner, address >> TLB_Config.Page_Bit, &VPN) == false) return address;
+    return (Address_Typedef)((VPN << TLB_Config.Page_Bit) | (address & ((1u << TLB_Config.Page_Bit) - 1)));
+}
+
+void Print_Translation_Report()
+{
+    TLB_Typedef* TLB[3] = {&ITLB, &DTLB, &L2_TLB};
+    const char* Name[3] = {"ITLB", "DTLB", "L2 TLB"};
+    const char* Policy[3] = {"sequential", "random", "color"};
+
+    printf("\033[36m\033[4;1m6. ADDRESS TRANSLATION:\n\033[0m\n");
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        uint64_t Lookups = TLB[i]->Hit + TLB[i]->Miss;
+        printf("\033[36m\t+%s: %llu lookups, %llu hits, %llu misses, miss rate %1.4f\033[0m\n", Name[i], (unsigned long long) Lookups,
+        (unsigned long long) TLB[i]->Hit, (unsigned long long) TLB[i]->Miss, (Lookups == 0) ? 0.0 : (double) TLB[i]->Miss / Lookups);
+    }
+    printf("\033[36m\t+Page Walks: %llu\n\t+Average Page Walk Latency: %1.4f cycles\n\t+Mapped Pages: %llu (%s allocation, %u colors)\n\033[0m\n",
+    (unsigned long long) Translation.Walks, (Translation.Walks == 0) ? 0.0 : (double) Translation.Walk_Latency / Translation.Walks,
+    (unsigned long long) Translation.Page_Table.Count, Policy[TLB_Config.Allocation], Translation.Colors);
+}
+//Byte usage
+void Byte_Usage_Retire(Byte_Usage_Typedef* Usage, uint64_t* Mask)
+{
+    uint32_t Used = 0;
+
+    for (uint32_t i = 0; i < LINE_WORDS; i++)
+    {
+        Used += __builtin_popcountll(Mask[i]);
+        Mask[i] = 0;
+    }
+    if (Used == 0) return;
+    Usage->Retired_Lines++;
+    Usage->Retired_Bytes += Used;
+    Usage->Used_Histogram[((Used - 1) * USAGE_BUCKETS) / LINE_SIZE]++;
+}
+
+void Byte_Usage_Touch(Byte_Usage_Typedef* Usage, uint64_t* Mask, uint32_t Offset, uint32_t Size)
+{
+    //Unknown sizes count as a single byte
+    if (Size == 0) Size = 1;
+    for (uint32_t i = Offset; (i < Offset + Size) && (i < LINE_SIZE); i++)
+    {
+        Mask[i / 64] |= 1ULL << (i % 64);
+        Usage->Offset_Count[i]++;
+    }
+}
+
+void Byte_Usage_Access(unsigned int Operation, Address_Typedef address, uint32_t Size)
+{
+    Tag_Typedef Tag = address >> (SET_BIT + BYTE_BIT);
+    Set_Typedef Set = (address & SET_MASK) >> BYTE_BIT;
+    int Way;
+
+    if (Operation == FETCH)
+    {
+        Way = Instruction_Match_Find(Tag, Set);
+        if (Way < 0) return;
+        //A fill starts a new line in this way: account for the line it replaced
+        if (Access_Result.Outcome != ACCESS_HIT) Byte_Usage_Retire(&Instr_Usage, Instr_Byte_Used[Way][Set]);
+        Byte_Usage_Touch(&Instr_Usage, Instr_Byte_Used[Way][Set], address & BYTE_MASK, Size);
+    }
+    else
+    {
+        Way = Data_Match_Find(Tag, Set);
+        if (Way < 0) return;
+        if (Access_Result.Outcome != ACCESS_HIT) Byte_Usage_Retire(&Data_Usage, Data_Byte_Used[Way][Set]);
+        Byte_Usage_Touch(&Data_Usage, Data_Byte_Used[Way][Set], address & BYTE_MASK, Size);
+    }
+}
+
+void Byte_Usage_Invalidate(Address_Typedef address)
+{
+    Tag_Typedef Tag = address >> (SET_BIT + BYTE_BIT);
+    Set_Typedef Set = (address & SET_MASK) >> BYTE_BIT;
+    int Way;
+
+    if ((Way = Data_Match_Find(Tag, Set)) > -1) Byte_Usage_Retire(&Data_Usage, Data_Byte_Used[Way][Set]);
+    else if ((Way = Instruction_Match_Find(Tag, Set)) > -1) Byte_Usage_Retire(&Instr_Usage, Instr_Byte_Used[Way][Set]);
+}
+
+void Byte_Usage_Reset()
+{
+    memset(&Data_Usage, 0, sizeof(Byte_Usage_Typedef));
+    memset(&Instr_Usage, 0, sizeof(Byte_Usage_Typedef));
+    //Byte masks of the resident lines are cleared with their set, see Data_Set_Clear
+}
+
+void Print_Byte_Usage_Report()
+{
+    Byte_Usage_Typedef* Usage[2] = {&Data_Usage, &Instr_Usage};
+    const char* Name[2] = {"DATA CACHE", "INSTRUCTION CACHE"};
+    uint64_t Resident_Lines;
+    uint64_t Resident_Bytes;
+    uint32_t Used;
+
+    printf("\033[36m\033[4;1m7. LINE BYTE USAGE:\n\033[0m\n");
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        //Lines still in L1 are reported apart, they may be used further
+        Resident_Lines = 0;
+        Resident_Bytes = 0;
+        for (uint32_t Set = 0; Set < NUM_OF_SET; Set++)
+        {
+            //Sets of an older epoch were emptied by a reset
+            if (((i == 0) ? Data_Set_Epoch[Set] != Data_Epoch : Instr_Set_Epoch[Set] != Instr_Epoch)) continue;
+            for (uint32_t Way = 0; Way < ((i == 0) ? DATA_WAYS : INSTR_WAYS); Way++)
+            {
+                uint64_t* Mask = (i == 0) ? Data_Byte_Used[Way][Set] : Instr_Byte_Used[Way][Set];
+                Used = 0;
+                for (uint32_t j = 0; j < LINE_WORDS; j++) Used += __builtin_popcountll(Mask[j]);
+                if (Used > 0)
+                {
+                    Resident_Lines++;
+                    Resident_Bytes += Used;
+                }
+            }
+        }
+        printf("\033[36m\033[1m%c. %s:\033[0m\n", 'a' + i, Name[i]);
+        printf("\033[36m\t+Line-Crossing Accesses (split): %llu\n\t+Retired Lines: %llu, average %1.2f of %d bytes used\n\t+Resident Lines: %llu, average %1.2f of %d bytes used so far\033[0m\n",
+        (unsigned long long) Usage[i]->Split_Access, (unsigned long long) Usage[i]->Retired_Lines,
+        (Usage[i]->Retired_Lines == 0) ? 0.0 : (double) Usage[i]->Retired_Bytes / Usage[i]->Retired_Lines, LINE_SIZE,
+        (unsigned long long) Resident_Lines, (Resident_Lines == 0) ? 0.0 : (double) Resident_Bytes / Resident_Lines, LINE_SIZE);
+        printf("\033[36m\t+Retired Lines by Used Bytes:\033[0m\n");
+        for (uint32_t j = 0; j < USAGE_BUCKETS; j++)
+        {
+            printf("\033[36m\t   %3u-%3u: %llu\033[0m\n", j * (LINE_SIZE / USAGE_BUCKETS) + 1, (j + 1) * (LINE_SIZE / USAGE_BUCKETS), (unsigned long long) Usage[i]->Used_Histogram[j]);
+        }
+        printf("\033[36m\t+Accesses by Byte Offset:\033[0m");
+        for (uint32_t j = 0; j < LINE_SIZE; j++)
+        {
+            if ((j % 8) == 0) printf("\n\033[36m\t   0x%02x:", j);
+            printf(" %8llu", (unsigned long long) Usage[i]->Offset_Count[j]);
+        }
+        printf("\033[0m\n\n");
+    }
+}
+//Statistics export
+void Text_Append(Text_Buffer_Typedef* Buffer, const char* Format, ...)
+{
+    va_list Arguments;
+    int Length;
+
+    va_start(Arguments, Format);
+    Length = vsnprintf(NULL, 0, Format, Arguments);
+    va_end(Arguments);
+    if (Length < 0) return;
+    if (Buffer->Length + Length + 1 > Buffer->Capacity)
+    {
+        Buffer->Capacity = (Buffer->Length + Length + 1) * 2;
+        Buffer->Text = (char*) realloc(Buffer->Text, Buffer->Capacity);
+    }
+    va_start(Arguments, Format);
+    vsnprintf(Buffer->Text + Buffer->Length, Length + 1, Format, Arguments);
+    va_end(Arguments);
+    Buffer->Length += Length;
+}
+
+//Quoted JSON string: quotes, backslashes and control characters escaped
+void Text_Append_JSON_String(Text_Buffer_Typedef* Buffer, const char* Text)
+{
+    Text_Append(Buffer, "\"");
+    for (const unsigned char* c = (const unsigned char*) Text; *c != '\0'; c++)
+    {
+        switch (*c)
+        {
+        case '"':  Text_Append(Buffer, "\\\""); break;
+        case '\\': Text_Append(Buffer, "\\\\"); break;
+        case '\b': Text_Append(Buffer, "\\b"); break;
+        case '\f': Text_Append(Buffer, "\\f"); break;
+        case '\n': Text_Append(Buffer, "\\n"); break;
+        case '\r': Text_Append(Buffer, "\\r"); break;
+        case '\t': Text_Append(Buffer, "\\t"); break;
+        default:   Text_Append(Buffer, (*c < 0x20) ? "\\u%04x" : "%c", *c); break;
+        }
+    }
+    Text_Append(Buffer, "\"");
+}
+
+//CSV field (RFC 4180): quoted when it holds a comma, a quote or a line break, quotes doubled
+void Text_Append_CSV_Field(Text_Buffer_Typedef* Buffer, const char* Text)
+{
+    if (strpbrk(Text, ",\"\r\n") == NULL)
+    {
+        Text_Append(Buffer, "%s", Text);
+        return;
+    }
+    Text_Append(Buffer, "\"");
+    for (const char* c = Text; *c != '\0'; c++) Text_Append(Buffer, (*c == '"') ? "\"\"" : "%c", *c);
+    Text_Append(Buffer, "\"");
+}
+
+void Stats_Add_Counter(Stats_List_Typedef* List, const char* Group, const char* Name, uint64_t Counter)
+{
+    if (List->Count >= MAX_STATS_FIELDS) return;
+    List->Field[List->Count] = (Stats_Field_Typedef) {Group, Name, FIELD_COUNTER, Counter, 0.0, NULL, 0};
+    List->Count++;
+}
+
+void Stats_Add_Ratio(Stats_List_Typedef* List, const char* Group, const char* Name, double Ratio)
+{
+    if (List->Count >= MAX_STATS_FIELDS) return;
+    List->Field[List->Count] = (Stats_Field_Typedef) {Group, Name, FIELD_RATIO, 0, Ratio, NULL, 0};
+    List->Count++;
+}
+
+void Stats_Add_Array(Stats_List_Typedef* List, const char* Group, const char* Name, const uint64_t* Array, uint32_t Length)
+{
+    if (List->Count >= MAX_STATS_FIELDS) return;
+    List->Field[List->Count] = (Stats_Field_Typedef) {Group, Name, FIELD_ARRAY, 0, 0.0, Array, Length};
+    List->Count++;
+}
+
+void Collect_Stats_Fields(Stats_List_Typedef* List)
+{
+    uint64_t Data_Total = Data_Stats_Report.Data_Hit + Data_Stats_Report.Data_Miss;
+    uint64_t Instr_Total = Instr_Stats_Report.Instruction_Hit + Instr_Stats_Report.Instruction_Miss;
+
+    List->Count = 0;
+    Stats_Add_Counter(List, "data", "read_accesses", Data_Stats_Report.Data_Read_Access);
+    Stats_Add_Counter(List, "data", "write_accesses", Data_Stats_Report.Data_Write_Access);
+    Stats_Add_Counter(List, "data", "hits", Data_Stats_Report.Data_Hit);
+    Stats_Add_Counter(List, "data", "misses", Data_Stats_Report.Data_Miss);
+    Stats_Add_Counter(List, "data", "write_backs", Data_Stats_Report.Write_Back);
+    Stats_Add_Ratio(List, "data", "hit_ratio", (Data_Total == 0) ? 0.0 : (double) Data_Stats_Report.Data_Hit / Data_Total);
+    Stats_Add_Counter(List, "instr", "read_accesses", Instr_Stats_Report.Instruction_Read_Access);
+    Stats_Add_Counter(List, "instr", "write_accesses", Instr_Stats_Report.Instruction_Write_Access);
+    Stats_Add_Counter(List, "instr", "hits", Instr_Stats_Report.Instruction_Hit);
+    Stats_Add_Counter(List, "instr", "misses", Instr_Stats_Report.Instruction_Miss);
+    Stats_Add_Ratio(List, "instr", "hit_ratio", (Instr_Total == 0) ? 0.0 : (double) Instr_Stats_Report.Instruction_Hit / Instr_Total);
+    if (Three_C_Enable)
+    {
+        Stats_Add_Counter(List, "miss_class", "data_read_compulsory", Miss_Class[READ][MISS_COMPULSORY]);
+        Stats_Add_Counter(List, "miss_class", "data_read_capacity", Miss_Class[READ][MISS_CAPACITY]);
+        Stats_Add_Counter(List, "miss_class", "data_read_conflict", Miss_Class[READ][MISS_CONFLICT]);
+        Stats_Add_Counter(List, "miss_class", "data_read_invalidation", Miss_Class[READ][MISS_INVALIDATION]);
+        Stats_Add_Counter(List, "miss_class", "data_write_compulsory", Miss_Class[WRITE][MISS_COMPULSORY]);
+        Stats_Add_Counter(List, "miss_class", "data_write_capacity", Miss_Class[WRITE][MISS_CAPACITY]);
+        Stats_Add_Counter(List, "miss_class", "data_write_conflict", Miss_Class[WRITE][MISS_CONFLICT]);
+        Stats_Add_Counter(List, "miss_class", "data_write_invalidation", Miss_Class[WRITE][MISS_INVALIDATION]);
+        Stats_Add_Counter(List, "miss_class", "instr_fetch_compulsory", Miss_Class[FETCH][MISS_COMPULSORY]);
+        Stats_Add_Counter(List, "miss_class", "instr_fetch_capacity", Miss_Class[FETCH][MISS_CAPACITY]);
+        Stats_Add_Counter(List, "miss_class", "instr_fetch_conflict", Miss_Class[FETCH][MISS_CONFLICT]);
+        Stats_Add_Counter(List, "miss_class", "instr_fetch_invalidation", Miss_Class[FETCH][MISS_INVALIDATION]);
+    }
+    if (Timing_Config.Enable)
+    {
+        uint64_t Accesses = Data_MSHR.Accesses + Instr_MSHR.Accesses;
+        Timing_Model_Advance(&Data_MSHR, Sim_Cycle);
+        Timing_Model_Advance(&Instr_MSHR, Sim_Cycle);
+        Stats_Add_Counter(List, "timing", "cycles", Sim_Cycle);
+        Stats_Add_Ratio(List, "timing", "amat", (Accesses == 0) ? 0.0 : (double)(Data_MSHR.Total_Latency + Instr_MSHR.Total_Latency) / Accesses);
+        Stats_Add_Ratio(List, "timing", "data_amat", (Data_MSHR.Accesses == 0) ? 0.0 : (double) Data_MSHR.Total_Latency / Data_MSHR.Accesses);
+        Stats_Add_Counter(List, "timing", "data_primary_misses", Data_MSHR.Primary_Miss);
+        Stats_Add_Counter(List, "timing", "data_merged_misses", Data_MSHR.Merged_Miss);
+        Stats_Add_Counter(List, "timing", "data_memory_fills", Data_MSHR.Memory_Fill);
+        Stats_Add_Counter(List, "timing", "data_full_stalls", Data_MSHR.Full_Stall);
+        Stats_Add_Counter(List, "timing", "data_stall_cycles", Data_MSHR.Stall_Cycles);
+        Stats_Add_Ratio(List, "timing", "data_mlp", (Data_MSHR.Busy_Cycles == 0) ? 0.0 : (double) Data_MSHR.Occupancy_Sum / Data_MSHR.Busy_Cycles);
+        Stats_Add_Array(List, "timing", "data_mshr_occupancy", Data_MSHR.Occupancy, Timing_Config.MSHR_Entries + 1);
+        Stats_Add_Ratio(List, "timing", "instr_amat", (Instr_MSHR.Accesses == 0) ? 0.0 : (double) Instr_MSHR.Total_Latency / Instr_MSHR.Accesses);
+        Stats_Add_Counter(List, "timing", "instr_primary_misses", Instr_MSHR.Primary_Miss);
+        Stats_Add_Counter(List, "timing", "instr_merged_misses", Instr_MSHR.Merged_Miss);
+        Stats_Add_Counter(List, "timing", "instr_memory_fills", Instr_MSHR.Memory_Fill);
+        Stats_Add_Counter(List, "timing", "instr_full_stalls", Instr_MSHR.Full_Stall);
+        Stats_Add_Counter(List, "timing", "instr_stall_cycles", Instr_MSHR.Stall_Cycles);
+        Stats_Add_Ratio(List, "timing", "instr_mlp", (Instr_MSHR.Busy_Cycles == 0) ? 0.0 : (double) Instr_MSHR.Occupancy_Sum / Instr_MSHR.Busy_Cycles);
+        Stats_Add_Array(List, "timing", "instr_mshr_occupancy", Instr_MSHR.Occupancy, Timing_Config.MSHR_Entries + 1);
+    }
+    if (DRAM_Config.Enable)
+    {
+        uint64_t Requests = DRAM_State.Reads + DRAM_State.Writes;
+        uint64_t Elapsed = (DRAM_State.Last_Done > Sim_Cycle) ? DRAM_State.Last_Done : Sim_Cycle;
+        Stats_Add_Counter(List, "dram", "reads", DRAM_State.Reads);
+        Stats_Add_Counter(List, "dram", "writes", DRAM_State.Writes);
+        Stats_Add_Counter(List, "dram", "row_hits", DRAM_State.Row_Hit);
+        Stats_Add_Counter(List, "dram", "row_misses", DRAM_State.Row_Empty);
+        Stats_Add_Counter(List, "dram", "row_conflicts", DRAM_State.Row_Conflict);
+        Stats_Add_Ratio(List, "dram", "row_hit_rate", (Requests == 0) ? 0.0 : (double) DRAM_State.Row_Hit / Requests);
+        Stats_Add_Ratio(List, "dram", "read_latency", (DRAM_State.Reads == 0) ? 0.0 : (double) DRAM_State.Read_Latency / DRAM_State.Reads);
+        Stats_Add_Counter(List, "dram", "bus_busy_cycles", DRAM_State.Bus_Busy);
+        Stats_Add_Ratio(List, "dram", "bandwidth_utilization", (Elapsed == 0) ? 0.0 : (double) DRAM_State.Bus_Busy / Elapsed);
+    }
+    if (TLB_Config.Enable)
+    {
+        Stats_Add_Counter(List, "tlb", "itlb_hits", ITLB.Hit);
+        Stats_Add_Counter(List, "tlb", "itlb_misses", ITLB.Miss);
+        Stats_Add_Counter(List, "tlb", "dtlb_hits", DTLB.Hit);
+        Stats_Add_Counter(List, "tlb", "dtlb_misses", DTLB.Miss);
+        Stats_Add_Counter(List, "tlb", "l2tlb_hits", L2_TLB.Hit);
+        Stats_Add_Counter(List, "tlb", "l2tlb_misses", L2_TLB.Miss);
+        Stats_Add_Counter(List, "tlb", "page_walks", Translation.Walks);
+        Stats_Add_Ratio(List, "tlb", "walk_latency", (Translation.Walks == 0) ? 0.0 : (double) Translation.Walk_Latency / Translation.Walks);
+        Stats_Add_Counter(List, "tlb", "mapped_pages", Translation.Page_Table.Count);
+    }
+    if (Usage_Enable)
+    {
+        Stats_Add_Counter(List, "usage", "data_split_accesses", Data_Usage.Split_Access);
+        Stats_Add_Counter(List, "usage", "data_retired_lines", Data_Usage.Retired_Lines);
+        Stats_Add_Counter(List, "usage", "data_retired_bytes", Data_Usage.Retired_Bytes);
+        Stats_Add_Array(List, "usage", "data_used_bytes_histogram", Data_Usage.Used_Histogram, USAGE_BUCKETS);
+        Stats_Add_Array(List, "usage", "data_offset_accesses", Data_Usage.Offset_Count, LINE_SIZE);
+        Stats_Add_Counter(List, "usage", "instr_split_accesses", Instr_Usage.Split_Access);
+        Stats_Add_Counter(List, "usage", "instr_retired_lines", Instr_Usage.Retired_Lines);
+        Stats_Add_Counter(List, "usage", "instr_retired_bytes", Instr_Usage.Retired_Bytes);
+        Stats_Add_Array(List, "usage", "instr_used_bytes_histogram", Instr_Usage.Used_Histogram, USAGE_BUCKETS);
+        Stats_Add_Array(List, "usage", "instr_offset_accesses", Instr_Usage.Offset_Count, LINE_SIZE);
+    }
+    if (Reuse_Enable)
+    {
+        Stats_Add_Counter(List, "reuse", "data_accesses", Data_Reuse.Accesses);
+        Stats_Add_Counter(List, "reuse", "data_first_uses", Data_Reuse.First_Use);
+        Stats_Add_Array(List, "reuse", "data_distance_histogram", Data_Reuse.Distance, REUSE_BUCKETS);
+        Stats_Add_Array(List, "reuse", "data_time_histogram", Data_Reuse.Time, REUSE_BUCKETS);
+        Stats_Add_Counter(List, "reuse", "instr_accesses", Instr_Reuse.Accesses);
+        Stats_Add_Counter(List, "reuse", "instr_first_uses", Instr_Reuse.First_Use);
+        Stats_Add_Array(List, "reuse", "instr_distance_histogram", Instr_Reuse.Distance, REUSE_BUCKETS);
+        Stats_Add_Array(List, "reuse", "instr_time_histogram", Instr_Reuse.Time, REUSE_BUCKETS);
+    }
+    if (Heavy_Hitters > 0)
+    {
+        Heavy_Sketch_Typedef* Sketch[3] = {&Heavy_Miss, &Heavy_Evict, &Heavy_Write_Back};
+        const char* Name[3][3] = {{"miss_events", "miss_lines", "miss_counts"}, {"evict_events", "evict_lines", "evict_counts"},
+                                  {"write_back_events", "write_back_lines", "write_back_counts"}};
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            Heavy_Sketch_Sort(Sketch[i], Heavy_Hitters);
+            Stats_Add_Counter(List, "heavy_hitters", Name[i][0], Sketch[i]->Events);
+            Stats_Add_Array(List, "heavy_hitters", Name[i][1], Sketch[i]->Top_Line, Sketch[i]->Top);
+            Stats_Add_Array(List, "heavy_hitters", Name[i][2], Sketch[i]->Top_Count, Sketch[i]->Top);
+        }
+    }
+    if (Region_File != NULL)
+    {
+        //One entry per region in base order, the last one is "(unmapped)"
+        Stats_Add_Array(List, "regions", "data_hits", Regions.Data_Hit, Regions.Count + 1);
+        Stats_Add_Array(List, "regions", "data_misses", Regions.Data_Miss, Regions.Count + 1);
+        Stats_Add_Array(List, "regions", "write_backs", Regions.Write_Back, Regions.Count + 1);
+        Stats_Add_Array(List, "regions", "instr_hits", Regions.Instr_Hit, Regions.Count + 1);
+        Stats_Add_Array(List, "regions", "instr_misses", Regions.Instr_Miss, Regions.Count + 1);
+    }
+    if (Interval.Length > 0)
+    {
+        Stats_Add_Counter(List, "intervals", "windows", Interval.Windows);
+        Stats_Add_Counter(List, "intervals", "phase_changes", Interval.Phase);
+        Stats_Add_Counter(List, "intervals", "phase_start", Interval.Phase_Start);
+    }
+    if (Convergence.Tolerance > 0.0)
+    {
+        Stats_Add_Counter(List, "convergence", "converged", Convergence.Converged);
+        Stats_Add_Counter(List, "convergence", "access", Convergence.Converged ? Convergence.Access : Convergence.Total);
+    }
+    if (RV_Machine.Steps > 0) Stats_Add_Counter(List, "program", "instructions", RV_Machine.Steps);
+    if (Host_Perf.Enable)
+    {
+        //Simulation part, reports excluded
+        Host_Perf_Simulation(Host_Perf.Mark);
+        Stats_Add_Counter(List, "host", "cycles", Host_Perf.Mark[0]);
+        Stats_Add_Counter(List, "host", "instructions", Host_Perf.Mark[1]);
+        Stats_Add_Counter(List, "host", "llc_misses", Host_Perf.Mark[2]);
+        Stats_Add_Counter(List, "host", "branch_misses", Host_Perf.Mark[3]);
+        Stats_Add_Counter(List, "host", "dtlb_misses", Host_Perf.Mark[4]);
+    }
+}
+
+void Format_Stats_JSON(Text_Buffer_Typedef* Buffer, const char* Reason)
+{
+    Stats_List_Typedef List;
+    const char* Group = NULL;
+
+    //One object per snapshot: {"snapshot":N,"reason":"...","trace":"...","data":{...},...}
+    Collect_Stats_Fields(&List);
+    Text_Append(Buffer, "{\"snapshot\":%" PRIu64 ",\"reason\":\"%s\",\"trace\":", Snapshot_Index, Reason);
+    Text_Append_JSON_String(Buffer, (Trace_Name != NULL) ? Trace_Name : "");
+    for (uint32_t i = 0; i < List.Count; i++)
+    {
+        Stats_Field_Typedef* Field = &List.Field[i];
+        if ((Group == NULL) || strcmp(Group, Field->Group))
+        {
+            Text_Append(Buffer, "%s,\"%s\":{", (Group == NULL) ? "" : "}", Field->Group);
+            Group = Field->Group;
+        }
+        else Text_Append(Buffer, ",");
+        Text_Append(Buffer, "\"%s\":", Field->Name);
+        if (Field->Kind == FIELD_COUNTER) Text_Append(Buffer, "%" PRIu64, Field->Counter);
+        else if (Field->Kind == FIELD_RATIO) Text_Append(Buffer, "%.9g", Field->Ratio);
+        else
+        {
+            for (uint32_t j = 0; j < Field->Length; j++) Text_Append(Buffer, "%c%" PRIu64, (j == 0) ? '[' : ',', Field->Array[j]);
+            Text_Append(Buffer, (Field->Length == 0) ? "[]" : "]");
+        }
+    }
+    Text_Append(Buffer, (Group == NULL) ? "}" : "}}");
+}
+
+void Format_Stats_CSV(Text_Buffer_Typedef* Buffer, const char* Reason, bool Header)
+{
+    Stats_List_Typedef List;
+
+    //Arrays are spread over <name>_<index> columns
+    Collect_Stats_Fields(&List);
+    if (Header) Text_Append(Buffer, "snapshot,reason,trace");
+    else
+    {
+        Text_Append(Buffer, "%" PRIu64 ",%s,", Snapshot_Index, Reason);
+        Text_Append_CSV_Field(Buffer, (Trace_Name != NULL) ? Trace_Name : "");
+    }
+    for (uint32_t i = 0; i < List.Count; i++)
+    {
+        Stats_Field_Typedef* Field = &List.Field[i];
+        if (Field->Kind == FIELD_ARRAY)
+        {
+            for (uint32_t j = 0; j < Field->Length; j++)
+            {
+                if (Header) Text_Append(Buffer, ",%s_%s_%u", Field->Group, Field->Name, j);
+                else Text_Append(Buffer, ",%" PRIu64, Field->Array[j]);
+            }
+        }
+        else if (Header) Text_Append(Buffer, ",%s_%s", Field->Group, Field->Name);
+        else if (Field->Kind == FIELD_COUNTER) Text_Append(Buffer, ",%" PRIu64, Field->Counter);
+        else Text_Append(Buffer, ",%.9g", Field->Ratio);
+    }
+}
+
+void Export_Stats_Snapshot(const char* Reason)
+{
+    Text_Buffer_Typedef Buffer = {NULL, 0, 0};
+
+    if ((Stats_JSON == NULL) && (Stats_CSV == NULL)) return;
+    Snapshot_Index++;
+    if (Stats_JSON != NULL)
+    {
+        Format_Stats_JSON(&Buffer, Reason);
+        fprintf(Stats_JSON, "%s\n", Buffer.Text);
+        Buffer.Length = 0;
+    }
+    if (Stats_CSV != NULL)
+    {
+        if (Snapshot_Index == 1)
+        {
+            Format_Stats_CSV(&Buffer, Reason, true);
+            fprintf(Stats_CSV, "%s\n", Buffer.Text);
+            Buffer.Length = 0;
+        }
+        Format_Stats_CSV(&Buffer, Reason, false);
+        fprintf(Stats_CSV, "%s\n", Buffer.Text);
+    }
+    free(Buffer.Text);
+}
+
+//Event log
+bool Event_Log_Open()
+{
+    Event_Log_Header_Typedef Header = {"L1EVENT", EVENT_VERSION, ADDRESS_BIT};
+
+    Event_Log.Count = 0;
+    Event_Log.Events = 0;
+    if ((Event_Log.File = fopen(Event_Log_File, "wb")) == NULL) return false;
+    Event_Log.Buffer = (Cache_Event_Typedef*) malloc(EVENT_BUFFER * sizeof(Cache_Event_Typedef));
+    if ((Event_Log.Buffer == NULL) || (fwrite(&Header, sizeof(Header), 1, Event_Log.File) != 1))
+    {
+        Event_Log_Close();
+        return false;
+    }
+    return true;
+}
+
+void Event_Log_Flush()
+{
+    if ((Event_Log.File == NULL) || (Event_Log.Count == 0)) return;
+    fwrite(Event_Log.Buffer, sizeof(Cache_Event_Typedef), Event_Log.Count, Event_Log.File);
+    Event_Log.Count = 0;
+}
+
+void Event_Log_Close()
+{
+    if (Event_Log.File != NULL)
+    {
+        Event_Log_Flush();
+        if (ferror(Event_Log.File)) printf("\033[31mERROR: Cannot write the event log %s\033[0m\n", Event_Log_File);
+        fclose(Event_Log.File);
+    }
+    free(Event_Log.Buffer);
+    Event_Log.File = NULL;
+    Event_Log.Buffer = NULL;
+}
+
+void Log_Cache_Event(unsigned int Operation, Address_Typedef address)
+{
+    PROFILE_SCOPE(PROFILE_LOGGING);
+    Cache_Event_Typedef Event = {0};
+
+    if (Operation == READ) Event.Index = Data_Stats_Report.Data_Read_Access;
+    else if (Operation == WRITE) Event.Index = Data_Stats_Report.Data_Write_Access;
+    else if (Operation == FETCH) Event.Index = Instr_Stats_Report.Instruction_Read_Access;
+    Event.Address = address;
+    Event.Operation = Operation;
+    Event.Outcome = Access_Result.Outcome;
+    switch (Access_Result.Outcome)
+    {
+    case ACCESS_HIT:
+    case ACCESS_INVALIDATE:
+        Event.Message = L2_NONE;
+        break;
+
+    case ACCESS_INVALIDATE_WRITE_BACK:
+        Event.Message = L2_WRITE;
+        Event.Victim = Access_Result.Victim_Address;
+        break;
+
+    default:
+        //Every miss fills the line from L2, the victim (if any) comes with the outcome
+        Event.Message = (Operation == WRITE) ? L2_RFO : L2_READ;
+        if (Access_Result.Outcome != ACCESS_MISS) Event.Victim = Access_Result.Victim_Address;
+        break;
+    }
+    if (Event_Log.File == NULL)
+    {
+        if ((Event.Outcome == ACCESS_HIT) && (Hit_Show != 1)) return;
+        if (Log_Ring.Enable) Async_Log_Push(&Event);
+        else Print_Cache_Event(stdout, &Event, Hit_Show);
+        return;
+    }
+    Event_Log.Buffer[Event_Log.Count++] = Event;
+    Event_Log.Events++;
+    if (Event_Log.Count == EVENT_BUFFER) Event_Log_Flush();
+}
+
+int Format_Cache_Event(char* Text, size_t Size, const Cache_Event_Typedef* Event, int Show_Hits)
+{
+    //Same text as the Mode 1 messages, including the historical spacing of each cache
+    const char* Access = (Event->Operation == WRITE) ? "WRITE ACCESS" : "READ_ ACCESS";
+    const char* Cache = (Event->Operation == FETCH) ? "L1(INSTR)" : "L1(DATA) ";
+    const char* Miss = (Event->Operation == WRITE) ? "WRITE MISS -" : "READ MISS  -";
+    const char* Fill = (Event->Message == L2_RFO) ? "Read for Ownership from L2" : "Read from L2";
+    Address_Typedef address = (Address_Typedef) Event->Address;
+    Address_Typedef Victim = (Address_Typedef) Event->Victim;
+
+    switch (Event->Outcome)
+    {
+    case ACCESS_HIT:
+        if (Show_Hits != 1) return 0;
+        if (Event->Operation == READ) Access = "READ ACCESS";
+        return snprintf(Text, Size, "\033[33m[%s %6" PRIu64 "] %s %s HIT <0x" ADDR_FMT ">\033[0m\n", Access, Event->Index, Cache, (Event->Operation == WRITE) ? "WRITE" : "READ", address);
+
+    case ACCESS_MISS:
+        return snprintf(Text, Size, "\033[33;4m[%s %6" PRIu64 "] %s %s %s <0x" ADDR_FMT ">\033[0m\n", Access, Event->Index, Cache, Miss, Fill, address);
+
+    case ACCESS_MISS_EVICT:
+    case ACCESS_MISS_REPLACE:
+        return snprintf(Text, Size, "\033[33;4m[%s %6" PRIu64 "] %s %s L1 evict <0x" ADDR_FMT "> - %s <0x" ADDR_FMT ">%s\033[0m\n", Access, Event->Index, Cache, Miss, Victim, Fill, address,
+        ((Event->Operation == WRITE) && (Event->Outcome == ACCESS_MISS_REPLACE)) ? ")" : "");
+
+    case ACCESS_MISS_WRITE_BACK:
+        return snprintf(Text, Size, "\033[33;4m[%s %6" PRIu64 "] %s %s Write to L2 <0x" ADDR_FMT "> - %s <0x" ADDR_FMT ">\033[0m\n", Access, Event->Index, Cache, Miss, Victim, Fill, address);
+
+    case ACCESS_INVALIDATE_WRITE_BACK:
+        return snprintf(Text, Size, "\033[33;4mEVICTION FROM L2 - Write to L2 <0x" ADDR_FMT ">\033[0m\n", address);
+
+    default:
+        return 0;
+    }
+}
+
+void Print_Cache_Event(FILE* Output, const Cache_Event_Typedef* Event, int Show_Hits)
+{
+    char Text[MAX_TRACES];
+
+    if (Format_Cache_Event(Text, sizeof(Text), Event, Show_Hits) > 0) fputs(Text, Output);
+}
+
+//Asynchronous log
+bool Async_Log_Start()
+{
+    Log_Ring.Show_Hits = Hit_Show;
+    Log_Ring.Slot = (Cache_Event_Typedef*) malloc(Log_Ring.Size * sizeof(Cache_Event_Typedef));
+    Log_Ring.Tail_Cache = Log_Ring.Enqueued = Log_Ring.Dropped = Log_Ring.Full_Waits = 0;
+    atomic_init(&Log_Ring.Head, 0);
+    atomic_init(&Log_Ring.Tail, 0);
+    atomic_init(&Log_Ring.Written, 0);
+    atomic_init(&Log_Ring.Stop, false);
+    if (Log_Ring.Slot == NULL) return false;
+    if (pthread_create(&Log_Ring.Thread, NULL, Async_Log_Thread, &Log_Ring) != 0)
+    {
+        free(Log_Ring.Slot);
+        Log_Ring.Slot = NULL;
+        return false;
+    }
+    return true;
+}
+
+void Async_Log_Push(const Cache_Event_Typedef* Event)
+{
+    uint64_t Head = atomic_load_explicit(&Log_Ring.Head, memory_order_relaxed);
+    struct timespec Start, Now, Pause = {0, 1000};
+
+    if (Head - Log_Ring.Tail_Cache >= Log_Ring.Size)
+    {
+        Log_Ring.Tail_Cache = atomic_load_explicit(&Log_Ring.Tail, memory_order_acquire);
+        if (Head - Log_Ring.Tail_Cache >= Log_Ring.Size)
+        {
+            //Backpressure: drop right away, or wait for the log thread no longer than Wait_US
+            Log_Ring.Full_Waits++;
+            if (Log_Ring.Policy == LOG_DROP)
+            {
+                Log_Ring.Dropped++;
+                return;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &Start);
+            do {
+                nanosleep(&Pause, NULL);
+                clock_gettime(CLOCK_MONOTONIC, &Now);
+                if ((uint64_t)(Now.tv_sec - Start.tv_sec) * 1000000 + (Now.tv_nsec - Start.tv_nsec) / 1000 > Log_Ring.Wait_US)
+                {
+                    Log_Ring.Dropped++;
+                    return;
+                }
+                Log_Ring.Tail_Cache = atomic_load_explicit(&Log_Ring.Tail, memory_order_acquire);
+            } while (Head - Log_Ring.Tail_Cache >= Log_Ring.Size);
+        }
+    }
+    Log_Ring.Slot[Head & (Log_Ring.Size - 1)] = *Event;
+    atomic_store_explicit(&Log_Ring.Head, Head + 1, memory_order_release);
+    Log_Ring.Enqueued++;
+}
+
+void* Async_Log_Thread(void* Argument)
+{
+    Log_Ring_Typedef* Ring = (Log_Ring_Typedef*) Argument;
+    char* Chunk = (char*) malloc(LOG_CHUNK);
+    size_t Length = 0;
+    uint64_t Tail = 0, Head;
+    uint32_t Idle = 0;
+    struct timespec Pause;
+    int Written;
+
+    while (true)
+    {
+        Head = atomic_load_explicit(&Ring->Head, memory_order_acquire);
+        if (Tail == Head)
+        {
+            //Ring empty: hand the pending text to the output stream, then back off
+            if (Length > 0)
+            {
+                fwrite(Chunk, 1, Length, stdout);
+                Length = 0;
+            }
+            atomic_store_explicit(&Ring->Written, Tail, memory_order_release);
+            if (atomic_load_explicit(&Ring->Stop, memory_order_acquire) && (Tail == atomic_load_explicit(&Ring->Head, memory_order_acquire))) break;
+            Pause.tv_sec = 0;
+            Pause.tv_nsec = (Idle < 10) ? 1000 << Idle : 1000000;
+            if (Idle < 10) Idle++;
+            nanosleep(&Pause, NULL);
+            continue;
+        }
+        Idle = 0;
+        for (; Tail != Head; Tail++)
+        {
+            if (LOG_CHUNK - Length < MAX_TRACES)
+            {
+                fwrite(Chunk, 1, Length, stdout);
+                Length = 0;
+            }
+            Written = Format_Cache_Event(&Chunk[Length], LOG_CHUNK - Length, &Ring->Slot[Tail & (Ring->Size - 1)], Ring->Show_Hits);
+            if (Written > 0) Length += Written;
+            //Free the slot as soon as it is formatted
+            atomic_store_explicit(&Ring->Tail, Tail + 1, memory_order_release);
+        }
+    }
+    free(Chunk);
+    return NULL;
+}
+
+void Async_Log_Drain()
+{
+    struct timespec Pause = {0, 1000};
+
+    if ((Log_Ring.Enable == false) || (Log_Ring.Slot == NULL)) return;
+    while (atomic_load_explicit(&Log_Ring.Written, memory_order_acquire) != atomic_load_explicit(&Log_Ring.Head, memory_order_relaxed)) nanosleep(&Pause, NULL);
+}
+
+void Async_Log_Stop()
+{
+    if ((Log_Ring.Enable == false) || (Log_Ring.Slot == NULL)) return;
+    atomic_store_explicit(&Log_Ring.Stop, true, memory_order_release);
+    pthread_join(Log_Ring.Thread, NULL);
+    free(Log_Ring.Slot);
+    Log_Ring.Slot = NULL;
+    if (Quiet == false) printf("\033[32m   Async log: %" PRIu64 " messages, %" PRIu64 " dropped, ring full %" PRIu64 " times\n\033[0m", Log_Ring.Enqueued, Log_Ring.Dropped, Log_Ring.Full_Waits);
+}
+
+//3C miss classification
+bool Shadow_Init(Shadow_Cache_Typedef* Shadow, uint32_t Capacity)
+{
+    uint32_t Buckets = 1;
+
+    while (Buckets < SHADOW_BUCKETS * Capacity) Buckets <<= 1;
+    Shadow->Capacity = Capacity;
+    Shadow->Bucket_Mask = Buckets - 1;
+    Shadow->Node = (Shadow_Node_Typedef*) malloc(Capacity * sizeof(Shadow_Node_Typedef));
+    Shadow->Bucket = (uint32_t*) malloc(Buckets * sizeof(uint32_t));
+    if ((Seen_Filter_Init(&Shadow->Seen, Seen_Filter_Bit) == false) || (Shadow->Node == NULL) || (Shadow->Bucket == NULL)) return false;
+    memset(Shadow->Bucket, 0xFF, Buckets * sizeof(uint32_t));
+    Shadow->Used = 0;
+    Shadow_Clear(Shadow);
+    return true;
+}
+
+void Shadow_Clear(Shadow_Cache_Typedef* Shadow)
+{
+    //Only the buckets of the nodes handed out hold a line
+    for (uint32_t i = 0; i < Shadow->Used; i++) *Shadow_Bucket(Shadow, Shadow->Node[i].Line) = SHADOW_NIL;
+    Seen_Filter_Clear(&Shadow->Seen);
+    Shadow->Head = Shadow->Tail = SHADOW_NIL;
+    Shadow->Used = 0;
+}
+
+void Shadow_Unlink(Shadow_Cache_Typedef* Shadow, uint32_t Node)
+{
+    Shadow_Node_Typedef* Entry = &Shadow->Node[Node];
+
+    if (Entry->Prev != SHADOW_NIL) Shadow->Node[Entry->Prev].Next = Entry->Next;
+    else Shadow->Head = Entry->Next;
+    if (Entry->Next != SHADOW_NIL) Shadow->Node[Entry->Next].Prev = Entry->Prev;
+    else Shadow->Tail = Entry->Prev;
+}
+
+//The low line bits are the L1 set, the tag spreads the lines of one set over the buckets
+uint32_t* Shadow_Bucket(Shadow_Cache_Typedef* Shadow, uint64_t Line)
+{
+    uint64_t Spread = ((Line >> SET_BIT) * 0x9E3779B97F4A7C15ull) >> 32;
+
+    return &Shadow->Bucket[(Line ^ Spread) & Shadow->Bucket_Mask];
+}
+
+uint32_t Shadow_Find(Shadow_Cache_Typedef* Shadow, uint32_t* Bucket, uint64_t Line)
+{
+    uint32_t Node = *Bucket;
+
+    while ((Node != SHADOW_NIL) && (Shadow->Node[Node].Line != Line)) Node = Shadow->Node[Node].Chain;
+    return Node;
+}
+
+//Class the access would have if it missed in the real cache
+uint8_t Shadow_Access(Shadow_Cache_Typedef* Shadow, uint64_t Line)
+{
+    uint32_t* Bucket = Shadow_Bucket(Shadow, Line);
+    uint32_t* Link;
+    uint32_t Node = Shadow_Find(Shadow, Bucket, Line);
+    uint8_t Class;
+
+    if (Node != SHADOW_NIL)
+    {
+        Class = Shadow->Node[Node].Invalidated ? MISS_INVALIDATION : MISS_CONFLICT;
+        Shadow->Node[Node].Invalidated = false;
+        if (Node == Shadow->Head) return Class;
+        Shadow_Unlink(Shadow, Node);
+    }
+    else
+    {
+        //Resident lines are in the filter already, only shadow misses probe it
+        Class = Seen_Filter_Add(&Shadow->Seen, Line) ? MISS_CAPACITY : MISS_COMPULSORY;
+        //Take a fresh node, or the least recently used line
+        if (Shadow->Used < Shadow->Capacity) Node = Shadow->Used++;
+        else
+        {
+            Node = Shadow->Tail;
+            Shadow_Unlink(Shadow, Node);
+            for (Link = Shadow_Bucket(Shadow, Shadow->Node[Node].Line); *Link != Node; Link = &Shadow->Node[*Link].Chain);
+            *Link = Shadow->Node[Node].Chain;
+        }
+        Shadow->Node[Node].Line = Line;
+        Shadow->Node[Node].Invalidated = false;
+        Shadow->Node[Node].Chain = *Bucket;
+        *Bucket = Node;
+    }
+    Shadow->Node[Node].Prev = SHADOW_NIL;
+    Shadow->Node[Node].Next = Shadow->Head;
+    if (Shadow->Head != SHADOW_NIL) Shadow->Node[Shadow->Head].Prev = Node;
+    else Shadow->Tail = Node;
+    Shadow->Head = Node;
+    return Class;
+}
+
+//The line keeps its place in the LRU order, an invalidation is not a replacement
+void Shadow_Invalidate(Shadow_Cache_Typedef* Shadow, uint64_t Line)
+{
+    uint32_t Node = Shadow_Find(Shadow, Shadow_Bucket(Shadow, Line), Line);
+
+    if (Node != SHADOW_NIL) Shadow->Node[Node].Invalidated = true;
+}
+
+bool Seen_Filter_Init(Seen_Filter_Typedef* Filter, uint8_t Bit)
+{
+    Filter->Words = 1ull << (Bit - 6);
+    Filter->Word = (uint64_t*) calloc(Filter->Words, sizeof(uint64_t));
+    Filter->Dirty = (uint64_t*) calloc(Filter->Words / 64, sizeof(uint64_t));
+    Filter->Bits_Set = Filter->Lines = 0;
+    return (Filter->Word != NULL) && (Filter->Dirty != NULL);
+}
+
+//Adds the line, true when all its bits were set already: seen before, or a false positive
+bool Seen_Filter_Add(Seen_Filter_Typedef* Filter, uint64_t Line)
+{
+    uint64_t Hash = Hash_Line(Line);
+    uint64_t Index = Hash & (Filter->Words - 1);
+    uint64_t Mask = 0;
+    uint64_t New;
+
+    //The word index takes at most the low 28 bits, the bit positions come from the high ones
+    for (uint8_t i = 0; i < SEEN_PROBES; i++) Mask |= 1ull << ((Hash >> (46 + 6 * i)) & 63);
+    New = Mask & ~Filter->Word[Index];
+    if (New == 0) return true;
+    if (Filter->Word[Index] == 0) Filter->Dirty[Index >> 6] |= 1ull << (Index & 63);
+    Filter->Word[Index] |= New;
+    Filter->Bits_Set += __builtin_popcountll(New);
+    Filter->Lines++;
+    return false;
+}
+
+void Seen_Filter_Clear(Seen_Filter_Typedef* Filter)
+{
+    uint64_t Dirty;
+
+    for (uint64_t i = 0; (Filter->Bits_Set > 0) && (i < Filter->Words / 64); i++)
+    {
+        for (Dirty = Filter->Dirty[i]; Dirty != 0; Dirty &= Dirty - 1) Filter->Word[(i << 6) + __builtin_ctzll(Dirty)] = 0;
+        Filter->Dirty[i] = 0;
+    }
+    Filter->Bits_Set = Filter->Lines = 0;
+}
+
+void Seen_Filter_Release(Seen_Filter_Typedef* Filter)
+{
+    free(Filter->Word);
+    free(Filter->Dirty);
+    Filter->Word = Filter->Dirty = NULL;
+}
+
+//Chance that a line never seen finds its bits set, from the average fill of the words
+double Seen_Filter_False_Positive(Seen_Filter_Typedef* Filter)
+{
+    double Fill = (double) Filter->Bits_Set / (Filter->Words * 64);
+    double Chance = 1.0;
+
+    for (uint8_t i = 0; i < SEEN_PROBES; i++) Chance *= Fill;
+    return Chance;
+}
+
+bool Miss_Class_Init()
+{
+    bool OK = true;
+
+    OK = OK && Shadow_Init(&Data_Shadow, DATA_WAYS * NUM_OF_SET);
+    OK = OK && Shadow_Init(&Instr_Shadow, INSTR_WAYS * NUM_OF_SET);
+    return OK;
+}
+
+void Miss_Class_Access(unsigned int Operation, Address_Typedef address)
+{
+    //The shadow cache sees every access to keep its LRU order
+    uint8_t Class = Shadow_Access((Operation == FETCH) ? &Instr_Shadow : &Data_Shadow, address >> BYTE_BIT);
+
+    if (Access_Result.Outcome != ACCESS_HIT) Miss_Class[Operation][Class]++;
+}
+
+void Miss_Class_Invalidate(Address_Typedef address)
+{
+    //The line left L1 without a replacement, its next miss is an invalidation miss
+    Shadow_Invalidate(&Data_Shadow, address >> BYTE_BIT);
+    Shadow_Invalidate(&Instr_Shadow, address >> BYTE_BIT);
+}
+
+void Miss_Class_Reset()
+{
+    if (Data_Shadow.Node == NULL) return;
+    Shadow_Clear(&Data_Shadow);
+    Shadow_Clear(&Instr_Shadow);
+    memset(Miss_Class, 0, sizeof(Miss_Class));
+}
+
+void Miss_Class_Release()
+{
+    Shadow_Cache_Typedef* Shadow[2] = {&Data_Shadow, &Instr_Shadow};
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        Seen_Filter_Release(&Shadow[i]->Seen);
+        free(Shadow[i]->Node);
+        free(Shadow[i]->Bucket);
+        Shadow[i]->Node = NULL;
+        Shadow[i]->Bucket = NULL;
+    }
+}
+
+void Print_Miss_Class_Report()
+{
+    const char* Name[3] = {"Data Cache Read", "Data Cache Write", "Instruction Cache Fetch"};
+
+    printf("\033[36m\033[1mc. MISS CLASSIFICATION (3C):\033[0m\n");
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        printf("\033[36m\t+%s Misses: compulsory %" PRIu64 ", capacity %" PRIu64 ", conflict %" PRIu64 ", invalidation %" PRIu64 "\033[0m\n",
+        Name[i], Miss_Class[i][MISS_COMPULSORY], Miss_Class[i][MISS_CAPACITY], Miss_Class[i][MISS_CONFLICT], Miss_Class[i][MISS_INVALIDATION]);
+    }
+    //A false positive turns a compulsory miss into a capacity miss
+    printf("\033[36m\t+Seen-before filters: %" PRIu64 " data and %" PRIu64 " instruction lines, false positives about %1.4f%% and %1.4f%% (compulsory counted as capacity)\033[0m\n",
+    Data_Shadow.Seen.Lines, Instr_Shadow.Seen.Lines, 100.0 * Seen_Filter_False_Positive(&Data_Shadow.Seen), 100.0 * Seen_Filter_False_Positive(&Instr_Shadow.Seen));
+    printf("\n");
+}
+
+//Reuse histograms
+bool Reuse_Init(Reuse_Typedef* Reuse)
+{
+    Reuse->Size = REUSE_SLOTS;
+    Reuse->Tree = (uint32_t*) calloc(Reuse->Size + 1, sizeof(uint32_t));
+    Reuse->Slot_Line = (uint64_t*) malloc(Reuse->Size * sizeof(uint64_t));
+    Reuse->Slot_Time = (uint64_t*) malloc(Reuse->Size * sizeof(uint64_t));
+    if ((Hash_Map_Init(&Reuse->Last, 2 * REUSE_SLOTS) == false) || (Reuse->Tree == NULL) || (Reuse->Slot_Line == NULL) || (Reuse->Slot_Time == NULL)) return false;
+    Reuse_Reset(Reuse);
+    return true;
+}
+
+void Reuse_Reset(Reuse_Typedef* Reuse)
+{
+    Hash_Map_Clear(&Reuse->Last);
+    memset(Reuse->Tree, 0, (Reuse->Size + 1) * sizeof(uint32_t));
+    Reuse->Next = Reuse->Live = 0;
+    Reuse->Accesses = Reuse->First_Use = 0;
+    memset(Reuse->Distance, 0, sizeof(Reuse->Distance));
+    memset(Reuse->Time, 0, sizeof(Reuse->Time));
+}
+
+void Reuse_Release(Reuse_Typedef* Reuse)
+{
+    Hash_Map_Release(&Reuse->Last);
+    free(Reuse->Tree);
+    free(Reuse->Slot_Line);
+    free(Reuse->Slot_Time);
+    Reuse->Tree = NULL;
+    Reuse->Slot_Line = Reuse->Slot_Time = NULL;
+}
+
+void Reuse_Tree_Add(Reuse_Typedef* Reuse, uint32_t Slot, int32_t Delta)
+{
+    for (uint32_t i = Slot + 1; i <= Reuse->Size; i += i & (~i + 1)) Reuse->Tree[i] += Delta;
+}
+
+uint32_t Reuse_Tree_Prefix(Reuse_Typedef* Reuse, uint32_t Slot)
+{
+    uint32_t Sum = 0;
+
+    //Live slots from 0 to Slot
+    for (uint32_t i = Slot + 1; i > 0; i &= i - 1) Sum += Reuse->Tree[i];
+    return Sum;
+}
+
+bool Reuse_Compact(Reuse_Typedef* Reuse)
+{
+    uint32_t Count = 0;
+    uint64_t Value;
+
+    //Move the live slots to the front, keeping their order, and double the slots when more than half are live
+    for (uint32_t Slot = 0; Slot < Reuse->Next; Slot++)
+    {
+        if ((Hash_Map_Find(&Reuse->Last, Reuse->Slot_Line[Slot], &Value) == false) || (Value != Slot)) continue;
+        Reuse->Slot_Line[Count] = Reuse->Slot_Line[Slot];
+        Reuse->Slot_Time[Count] = Reuse->Slot_Time[Slot];
+        Hash_Map_Insert(&Reuse->Last, Reuse->Slot_Line[Count], Count);
+        Count++;
+    }
+    if (Count * 2 > Reuse->Size)
+    {
+        uint32_t* Tree = (uint32_t*) realloc(Reuse->Tree, (2 * Reuse->Size + 1) * sizeof(uint32_t));
+        uint64_t* Slot_Line = (uint64_t*) realloc(Reuse->Slot_Line, 2 * Reuse->Size * sizeof(uint64_t));
+        uint64_t* Slot_Time = (uint64_t*) realloc(Reuse->Slot_Time, 2 * Reuse->Size * sizeof(uint64_t));
+        if (Tree != NULL) Reuse->Tree = Tree;
+        if (Slot_Line != NULL) Reuse->Slot_Line = Slot_Line;
+        if (Slot_Time != NULL) Reuse->Slot_Time = Slot_Time;
+        if ((Tree == NULL) || (Slot_Line == NULL) || (Slot_Time == NULL)) return false;
+        Reuse->Size *= 2;
+    }
+    //Rebuild the tree in O(n): slots 0 to Count - 1 are live
+    memset(Reuse->Tree, 0, (Reuse->Size + 1) * sizeof(uint32_t));
+    for (uint32_t i = 1; i <= Count; i++) Reuse->Tree[i] = 1;
+    for (uint32_t i = 1; i <= Reuse->Size; i++)
+    {
+        uint32_t Parent = i + (i & (~i + 1));
+        if (Parent <= Reuse->Size) Reuse->Tree[Parent] += Reuse->Tree[i];
+    }
+    Reuse->Next = Reuse->Live = Count;
+    return true;
+}
+
+uint32_t Reuse_Bucket(uint64_t Value)
+{
+    uint32_t Bucket = (Value == 0) ? 0 : 64 - __builtin_clzll(Value);
+
+    return (Bucket < REUSE_BUCKETS) ? Bucket : REUSE_BUCKETS - 1;
+}
+
+void Reuse_Access(Reuse_Typedef* Reuse, uint64_t Line)
+{
+    uint64_t Value;
+    uint32_t Slot;
+
+    if ((Reuse->Next == Reuse->Size) && (Reuse_Compact(Reuse) == false)) return;
+    if (Hash_Map_Find(&Reuse->Last, Line, &Value))
+    {
+        //Every live slot after the previous use is a distinct line used in between
+        Slot = (uint32_t) Value;
+        Reuse->Distance[Reuse_Bucket(Reuse->Live - Reuse_Tree_Prefix(Reuse, Slot))]++;
+        Reuse->Time[Reuse_Bucket(Reuse->Accesses - Reuse->Slot_Time[Slot] - 1)]++;
+        Reuse_Tree_Add(Reuse, Slot, -1);
+        Reuse->Live--;
+    }
+    else Reuse->First_Use++;
+    Slot = Reuse->Next++;
+    Reuse->Slot_Line[Slot] = Line;
+    Reuse->Slot_Time[Slot] = Reuse->Accesses++;
+    Reuse_Tree_Add(Reuse, Slot, 1);
+    Reuse->Live++;
+    Hash_Map_Insert(&Reuse->Last, Line, Slot);
+}
+
+uint64_t Reuse_LRU_Hits(Reuse_Typedef* Reuse, uint64_t Lines)
+{
+    uint64_t Hits = 0;
+
+    //A fully associative LRU cache of Lines lines hits when fewer than Lines distinct lines were used in between
+    //Exact when Lines is a power of 2, otherwise counted for the power of 2 below it
+    for (uint32_t i = 0; (i <= (uint32_t)(63 - __builtin_clzll(Lines))) && (i < REUSE_BUCKETS); i++) Hits += Reuse->Distance[i];
+    return Hits;
+}
+
+void Print_Reuse_Report()
+{
+    Reuse_Typedef* Reuse[2] = {&Data_Reuse, &Instr_Reuse};
+    const char* Name[2] = {"DATA CACHE (READ + WRITE)", "INSTRUCTION CACHE (FETCH)"};
+    uint64_t Lines[2] = {DATA_WAYS * NUM_OF_SET, INSTR_WAYS * NUM_OF_SET};
+    uint32_t Last;
+
+    printf("\033[36m\033[4;1m8. REUSE DISTANCE AND REUSE TIME:\n\033[0m\n");
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        printf("\033[36m\033[1m%c. %s:\033[0m\n", 'a' + i, Name[i]);
+        printf("\033[36m\t+Line Accesses: %" PRIu64 ", first uses: %" PRIu64 "\033[0m\n", Reuse[i]->Accesses, Reuse[i]->First_Use);
+        if (Reuse[i]->Accesses == 0)
+        {
+            printf("\n");
+            continue;
+        }
+        //Hit ratio of a fully associative LRU cache: the gap to the real hit ratio is lost to set mapping,
+        //the gain from 1x to 2x is what a bigger cache would bring
+        printf("\033[36m\t+Fully Associative LRU Hit Ratio: %1.4f at %" PRIu64 " lines, %1.4f at 2x, %1.4f at 4x\033[0m\n",
+        (double) Reuse_LRU_Hits(Reuse[i], Lines[i]) / Reuse[i]->Accesses, Lines[i],
+        (double) Reuse_LRU_Hits(Reuse[i], 2 * Lines[i]) / Reuse[i]->Accesses, (double) Reuse_LRU_Hits(Reuse[i], 4 * Lines[i]) / Reuse[i]->Accesses);
+        Last = 0;
+        for (uint32_t j = 0; j < REUSE_BUCKETS; j++)
+        {
+            if ((Reuse[i]->Distance[j] != 0) || (Reuse[i]->Time[j] != 0)) Last = j;
+        }
+        printf("\033[36m\t   %-21s %14s %14s\033[0m\n", "Reuses", "by distance", "by time");
+        for (uint32_t j = 0; j <= Last; j++)
+        {
+            char Range[48]; //Two 20-digit bounds and the dash
+            if (j <= 1) snprintf(Range, sizeof(Range), "%u", j);
+            else if (j == REUSE_BUCKETS - 1) snprintf(Range, sizeof(Range), "%" PRIu64 "+", (uint64_t) 1 << (j - 1));
+            else snprintf(Range, sizeof(Range), "%" PRIu64 "-%" PRIu64, (uint64_t) 1 << (j - 1), ((uint64_t) 1 << j) - 1);
+            printf("\033[36m\t   %-21s %14" PRIu64 " %14" PRIu64 "\033[0m\n", Range, Reuse[i]->Distance[j], Reuse[i]->Time[j]);
+        }
+        printf("\n");
+    }
+}
+
+//Per-set heatmap
+void Set_Heat_Access(unsigned int Operation, Address_Typedef address)
+{
+    Set_Heat_Typedef* Heat = (Operation == FETCH) ? &Instr_Heat : &Data_Heat;
+    Set_Typedef Set = (address & SET_MASK) >> BYTE_BIT;
+
+    Heat->Access[Set]++;
+    switch (Access_Result.Outcome)
+    {
+    case ACCESS_HIT:
+        break;
+
+    case ACCESS_MISS_WRITE_BACK:
+        Heat->Write_Back[Set]++;
+        Heat->Evict[Set]++;
+        Heat->Miss[Set]++;
+        break;
+
+    case ACCESS_MISS_EVICT:
+        Heat->Evict[Set]++;
+        Heat->Miss[Set]++;
+        break;
+
+    default:
+        Heat->Miss[Set]++;
+        break;
+    }
+}
+
+void Set_Heat_Invalidate(Address_Typedef address)
+{
+    //An L2 eviction is not a conflict, only its write-back is counted
+    if (Access_Result.Outcome == ACCESS_INVALIDATE_WRITE_BACK) Data_Heat.Write_Back[(address & SET_MASK) >> BYTE_BIT]++;
+}
+
+void Set_Heat_Reset()
+{
+    memset(&Data_Heat, 0, sizeof(Data_Heat));
+    memset(&Instr_Heat, 0, sizeof(Instr_Heat));
+}
+
+void Heatmap_Export()
+{
+    Heatmap_Header_Typedef Header = {"L1HEAT", HEAT_VERSION, NUM_OF_SET};
+    Set_Heat_Typedef* Heat[2] = {&Data_Heat, &Instr_Heat};
+    const char* Name[2] = {"data", "instr"};
+
+    //One row per set of each cache, ready for a cache x set heatmap
+    if (Heatmap_CSV != NULL)
+    {
+        fprintf(Heatmap_CSV, "cache,set,accesses,misses,evictions,write_backs\n");
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            for (uint32_t Set = 0; Set < NUM_OF_SET; Set++)
+            {
+                fprintf(Heatmap_CSV, "%s,%u,%u,%u,%u,%u\n", Name[i], Set, Heat[i]->Access[Set], Heat[i]->Miss[Set], Heat[i]->Evict[Set], Heat[i]->Write_Back[Set]);
+            }
+        }
+        fclose(Heatmap_CSV);
+        Heatmap_CSV = NULL;
+    }
+    if (Heatmap_Bin != NULL)
+    {
+        if ((fwrite(&Header, sizeof(Header), 1, Heatmap_Bin) != 1) || (fwrite(&Data_Heat, sizeof(Data_Heat), 1, Heatmap_Bin) != 1) || (fwrite(&Instr_Heat, sizeof(Instr_Heat), 1, Heatmap_Bin) != 1))
+        {
+            printf("\033[31mERROR: Cannot write heatmap file!\033[0m\n");
+        }
+        fclose(Heatmap_Bin);
+        Heatmap_Bin = NULL;
+    }
+}
+
+void Print_Hot_Sets_Report()
+{
+    Set_Heat_Typedef* Heat[2] = {&Data_Heat, &Instr_Heat};
+    const char* Name[2] = {"DATA CACHE", "INSTRUCTION CACHE"};
+    uint32_t Top[MAX_HOT_SETS];
+    uint32_t Count;
+    uint32_t Missed;
+    uint64_t Misses;
+    uint64_t Top_Misses;
+
+    printf("\033[36m\033[4;1m9. HOT SETS (MOST MISSES):\n\033[0m\n");
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        //Keep the sets with the most misses in descending order, ties broken by accesses
+        Count = Missed = 0;
+        Misses = Top_Misses = 0;
+        for (uint32_t Set = 0; Set < NUM_OF_SET; Set++)
+        {
+            uint32_t Position;
+            if (Heat[i]->Miss[Set] == 0) continue;
+            Missed++;
+            Misses += Heat[i]->Miss[Set];
+            Position = (Count < Hot_Sets) ? Count++ : Hot_Sets;
+            while ((Position > 0) && ((Heat[i]->Miss[Set] > Heat[i]->Miss[Top[Position - 1]]) ||
+            ((Heat[i]->Miss[Set] == Heat[i]->Miss[Top[Position - 1]]) && (Heat[i]->Access[Set] > Heat[i]->Access[Top[Position - 1]]))))
+            {
+                if (Position < Hot_Sets) Top[Position] = Top[Position - 1];
+                Position--;
+            }
+            if (Position < Hot_Sets) Top[Position] = Set;
+        }
+        for (uint32_t j = 0; j < Count; j++) Top_Misses += Heat[i]->Miss[Top[j]];
+        printf("\033[36m\033[1m%c. %s:\033[0m\n", 'a' + i, Name[i]);
+        printf("\033[36m\t+Sets with misses: %u of %d, the top %u hold %1.2f%% of %" PRIu64 " misses\033[0m\n",
+        Missed, NUM_OF_SET, Count, (Misses == 0) ? 0.0 : 100.0 * Top_Misses / Misses, Misses);
+        if (Count > 0) printf("\033[36m\t   %-8s %12s %12s %10s %12s %12s\033[0m\n", "Set", "Accesses", "Misses", "Miss Ratio", "Evictions", "Write Backs");
+        for (uint32_t j = 0; j < Count; j++)
+        {
+            uint32_t Set = Top[j];
+            printf("\033[36m\t   0x%04x   %12u %12u %10.4f %12u %12u\033[0m\n", Set, Heat[i]->Access[Set], Heat[i]->Miss[Set],
+            (double) Heat[i]->Miss[Set] / Heat[i]->Access[Set], Heat[i]->Evict[Set], Heat[i]->Write_Back[Set]);
+        }
+        printf("\n");
+    }
+}
+
+//Heavy-hitter lines
+bool Heavy_Sketch_Init(Heavy_Sketch_Typedef* Sketch, uint32_t Capacity)
+{
+    Sketch->Capacity = Capacity;
+    Sketch->Heap = (Heavy_Counter_Typedef*) malloc(Capacity * sizeof(Heavy_Counter_Typedef));
+    if ((Hash_Map_Init(&Sketch->Index, 2 * Capacity) == false) || (Sketch->Heap == NULL)) return false;
+    Heavy_Sketch_Clear(Sketch);
+    return true;
+}
+
+void Heavy_Sketch_Clear(Heavy_Sketch_Typedef* Sketch)
+{
+    Hash_Map_Clear(&Sketch->Index);
+    Sketch->Used = 0;
+    Sketch->Events = 0;
+    Sketch->Top = 0;
+}
+
+void Heavy_Sketch_Release(Heavy_Sketch_Typedef* Sketch)
+{
+    Hash_Map_Release(&Sketch->Index);
+    free(Sketch->Heap);
+    Sketch->Heap = NULL;
+}
+
+void Heavy_Sketch_Sift_Up(Heavy_Sketch_Typedef* Sketch, uint32_t Position, Heavy_Counter_Typedef Entry)
+{
+    uint32_t Parent;
+
+    //Move parents down into the hole until Entry fits, every moved counter gets its new position
+    while (Position > 0)
+    {
+        Parent = (Position - 1) / 2;
+        if (Sketch->Heap[Parent].Count <= Entry.Count) break;
+        Sketch->Heap[Position] = Sketch->Heap[Parent];
+        Hash_Map_Insert(&Sketch->Index, Sketch->Heap[Position].Line, Position);
+        Position = Parent;
+    }
+    Sketch->Heap[Position] = Entry;
+    Hash_Map_Insert(&Sketch->Index, Entry.Line, Position);
+}
+
+void Heavy_Sketch_Sift_Down(Heavy_Sketch_Typedef* Sketch, uint32_t Position, Heavy_Counter_Typedef Entry)
+{
+    uint32_t Child;
+
+    while ((Child = 2 * Position + 1) < Sketch->Used)
+    {
+        if ((Child + 1 < Sketch->Used) && (Sketch->Heap[Child + 1].Count < Sketch->Heap[Child].Count)) Child++;
+        if (Entry.Count <= Sketch->Heap[Child].Count) break;
+        Sketch->Heap[Position] = Sketch->Heap[Child];
+        Hash_Map_Insert(&Sketch->Index, Sketch->Heap[Position].Line, Position);
+        Position = Child;
+    }
+    Sketch->Heap[Position] = Entry;
+    Hash_Map_Insert(&Sketch->Index, Entry.Line, Position);
+}
+
+void Heavy_Sketch_Add(Heavy_Sketch_Typedef* Sketch, uint64_t Line)
+{
+    uint64_t Position;
+    Heavy_Counter_Typedef Entry;
+
+    Sketch->Events++;
+    if (Hash_Map_Find(&Sketch->Index, Line, &Position))
+    {
+        Entry = Sketch->Heap[Position];
+        Entry.Count++;
+        Heavy_Sketch_Sift_Down(Sketch, (uint32_t) Position, Entry);
+    }
+    else if (Sketch->Used < Sketch->Capacity)
+    {
+        Entry = (Heavy_Counter_Typedef) {Line, 1, 0};
+        Heavy_Sketch_Sift_Up(Sketch, Sketch->Used++, Entry);
+    }
+    else
+    {
+        //The line takes over the smallest counter
+        Hash_Map_Remove(&Sketch->Index, Sketch->Heap[0].Line);
+        Entry = (Heavy_Counter_Typedef) {Line, Sketch->Heap[0].Count + 1, Sketch->Heap[0].Count};
+        Heavy_Sketch_Sift_Down(Sketch, 0, Entry);
+    }
+}
+
+void Heavy_Sketch_Sort(Heavy_Sketch_Typedef* Sketch, uint32_t Top)
+{
+    uint32_t Position;
+
+    //Insertion of every counter into the Top largest, in descending order
+    Sketch->Top = 0;
+    for (uint32_t i = 0; i < Sketch->Used; i++)
+    {
+        Heavy_Counter_Typedef* Entry = &Sketch->Heap[i];
+        Position = (Sketch->Top < Top) ? Sketch->Top++ : Top;
+        while ((Position > 0) && (Entry->Count > Sketch->Top_Count[Position - 1]))
+        {
+            if (Position < Top)
+            {
+                Sketch->Top_Line[Position] = Sketch->Top_Line[Position - 1];
+                Sketch->Top_Count[Position] = Sketch->Top_Count[Position - 1];
+                Sketch->Top_Error[Position] = Sketch->Top_Error[Position - 1];
+            }
+            Position--;
+        }
+        if (Position < Top)
+        {
+            Sketch->Top_Line[Position] = Entry->Line << BYTE_BIT;
+            Sketch->Top_Count[Position] = Entry->Count;
+            Sketch->Top_Error[Position] = Entry->Error;
+        }
+    }
+}
+
+bool Heavy_Hitters_Init()
+{
+    bool OK = true;
+
+    OK = OK && Heavy_Sketch_Init(&Heavy_Miss, Heavy_Counters);
+    OK = OK && Heavy_Sketch_Init(&Heavy_Evict, Heavy_Counters);
+    OK = OK && Heavy_Sketch_Init(&Heavy_Write_Back, Heavy_Counters);
+    return OK;
+}
+
+void Heavy_Hitters_Access(Address_Typedef address)
+{
+    switch (Access_Result.Outcome)
+    {
+    case ACCESS_HIT:
+        return;
+
+    case ACCESS_MISS_WRITE_BACK:
+        Heavy_Sketch_Add(&Heavy_Write_Back, Access_Result.Victim_Address >> BYTE_BIT);
+        Heavy_Sketch_Add(&Heavy_Evict, Access_Result.Victim_Address >> BYTE_BIT);
+        break;
+
+    case ACCESS_MISS_EVICT:
+        Heavy_Sketch_Add(&Heavy_Evict, Access_Result.Victim_Address >> BYTE_BIT);
+        break;
+
+    default:
+        break;
+    }
+    Heavy_Sketch_Add(&Heavy_Miss, address >> BYTE_BIT);
+}
+
+void Heavy_Hitters_Invalidate()
+{
+    //Dirty lines evicted by L2 are written back too
+    if (Access_Result.Outcome == ACCESS_INVALIDATE_WRITE_BACK) Heavy_Sketch_Add(&Heavy_Write_Back, Access_Result.Victim_Address >> BYTE_BIT);
+}
+
+void Heavy_Hitters_Reset()
+{
+    if (Heavy_Miss.Heap == NULL) return;
+    Heavy_Sketch_Clear(&Heavy_Miss);
+    Heavy_Sketch_Clear(&Heavy_Evict);
+    Heavy_Sketch_Clear(&Heavy_Write_Back);
+}
+
+void Heavy_Hitters_Release()
+{
+    Heavy_Sketch_Release(&Heavy_Miss);
+    Heavy_Sketch_Release(&Heavy_Evict);
+    Heavy_Sketch_Release(&Heavy_Write_Back);
+}
+
+void Print_Heavy_Hitters_Report(bool Final)
+{
+    Heavy_Sketch_Typedef* Sketch[3] = {&Heavy_Miss, &Heavy_Evict, &Heavy_Write_Back};
+    const char* Name[3] = {"MISSES", "EVICTIONS", "WRITE BACKS"};
+
+    if (Final)
+    {
+        if (Quiet) return;
+        Async_Log_Drain();
+        printf("\033[36m==============================================================================================================\033[0m\n");
+        printf("\033[36m\033[4;1mHEAVY HITTER LINES AT THE END OF THE RUN (DATA CACHE):\n\033[0m\n");
+    }
+    else printf("\033[36m\033[4;1m10. HEAVY HITTER LINES (DATA CACHE):\n\033[0m\n");
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        Heavy_Sketch_Sort(Sketch[i], Heavy_Hitters);
+        printf("\033[36m\033[1m%c. %s:\033[0m\n", 'a' + i, Name[i]);
+        printf("\033[36m\t+Events: %" PRIu64 ", lines tracked: %u of %u counters (counts over by at most %" PRIu64 ")\033[0m\n",
+        Sketch[i]->Events, Sketch[i]->Used, Sketch[i]->Capacity, (Sketch[i]->Used < Sketch[i]->Capacity) ? 0 : Sketch[i]->Heap[0].Count);
+        for (uint32_t j = 0; j < Sketch[i]->Top; j++)
+        {
+            printf("\033[36m\t   Line " ADDR_FMT ": %" PRIu64 " (at least %" PRIu64 ", %1.2f%%)\033[0m\n", (Address_Typedef) Sketch[i]->Top_Line[j],
+            Sketch[i]->Top_Count[j], Sketch[i]->Top_Count[j] - Sketch[i]->Top_Error[j], 100.0 * Sketch[i]->Top_Count[j] / Sketch[i]->Events);
+        }
+        printf("\n");
+    }
+    if (Final) printf("\033[36m==============================================================================================================\033[0m\n");
+}
+
+//Address regions
+int Region_Compare(const void* First, const void* Second)
+{
+    uint64_t First_Base = ((const Region_Typedef*) First)->Base;
+    uint64_t Second_Base = ((const Region_Typedef*) Second)->Base;
+
+    return (First_Base > Second_Base) - (First_Base < Second_Base);
+}
+
+bool Region_Load()
+{
+    FILE* fd = fopen(Region_File, "r");
+    char one_line[MAX_TRACES];
+    char* Token;
+    Region_Typedef Entry;
+    Region_Typedef* Bigger;
+
+    if (fd == NULL) return false;
+    memset(&Regions, 0, sizeof(Regions));
+    while (fgets(one_line, MAX_TRACES, fd) != NULL)
+    {
+        //Region line: <name> <base> <limit> in hex, limit is the last byte, '#' starts a comment
+        if ((Token = strchr(one_line, '#'))) *Token = '\0';
+        if (strspn(one_line, " \t\r\n") == strlen(one_line)) continue;
+        if ((sscanf(one_line, "%31s %" SCNx64 " %" SCNx64, Entry.Name, &Entry.Base, &Entry.Limit) != 3) || (Entry.Limit < Entry.Base))
+        {
+            printf("\033[31mERROR: Bad region line: %s\033[0m\n", one_line);
+            fclose(fd);
+            Region_Release();
+            return false;
+        }
+        if ((Bigger = (Region_Typedef*) realloc(Regions.Region, (Regions.Count + 2) * sizeof(Region_Typedef))) == NULL)
+        {
+            fclose(fd);
+            Region_Release();
+            return false;
+        }
+        Regions.Region = Bigger;
+        Regions.Region[Regions.Count++] = Entry;
+    }
+    fclose(fd);
+    if (Regions.Count == 0) return false;
+    qsort(Regions.Region, Regions.Count, sizeof(Region_Typedef), Region_Compare);
+    for (uint32_t i = 1; i < Regions.Count; i++)
+    {
+        if (Regions.Region[i].Base <= Regions.Region[i - 1].Limit)
+        {
+            printf("\033[31mERROR: Regions %s and %s overlap\033[0m\n", Regions.Region[i - 1].Name, Regions.Region[i].Name);
+            Region_Release();
+            return false;
+        }
+    }
+    //The unmapped region never matches a lookup
+    Regions.Region[Regions.Count] = (Region_Typedef) {"(unmapped)", 1, 0};
+    Regions.Base = (uint64_t*) malloc((Regions.Count + 1) * sizeof(uint64_t));
+    Regions.Limit = (uint64_t*) malloc((Regions.Count + 1) * sizeof(uint64_t));
+    Regions.Data_Hit = (uint64_t*) calloc(5 * (Regions.Count + 1), sizeof(uint64_t));
+    if ((Regions.Base == NULL) || (Regions.Limit == NULL) || (Regions.Data_Hit == NULL))
+    {
+        Region_Release();
+        return false;
+    }
+    Regions.Data_Miss = Regions.Data_Hit + (Regions.Count + 1);
+    Regions.Write_Back = Regions.Data_Miss + (Regions.Count + 1);
+    Regions.Instr_Hit = Regions.Write_Back + (Regions.Count + 1);
+    Regions.Instr_Miss = Regions.Instr_Hit + (Regions.Count + 1);
+    for (uint32_t i = 0; i <= Regions.Count; i++)
+    {
+        Regions.Base[i] = Regions.Region[i].Base;
+        Regions.Limit[i] = Regions.Region[i].Limit;
+    }
+    Regions.Data_Last = Regions.Instr_Last = Regions.Victim_Last = Regions.Count;
+    return true;
+}
+
+ALWAYS_INLINE uint32_t Region_Find(uint64_t address, uint32_t* Last)
+{
+    const uint64_t* Base = Regions.Base;
+    uint32_t Length = Regions.Count;
+    uint32_t Half;
+    uint32_t Region;
+
+    //Accesses of a stream mostly stay in one region
+    if ((address >= Regions.Base[*Last]) && (address <= Regions.Limit[*Last])) return *Last;
+    //Last region with a base not above the address, branch free so random addresses cost no mispredictions
+    while (Length > 1)
+    {
+        Half = Length / 2;
+        Base = (Base[Half] <= address) ? Base + Half : Base;
+        Length -= Half;
+    }
+    Region = (uint32_t)(Base - Regions.Base);
+    *Last = ((*Base <= address) && (address <= Regions.Limit[Region])) ? Region : Regions.Count;
+    return *Last;
+}
+
+void Region_Access(unsigned int Operation, Address_Typedef address)
+{
+    uint32_t Region;
+
+    if (Operation == FETCH)
+    {
+        Region = Region_Find(address, &Regions.Instr_Last);
+        if (Access_Result.Outcome == ACCESS_HIT) Regions.Instr_Hit[Region]++;
+        else Regions.Instr_Miss[Region]++;
+        return;
+    }
+    Region = Region_Find(address, &Regions.Data_Last);
+    if (Access_Result.Outcome == ACCESS_HIT) Regions.Data_Hit[Region]++;
+    else Regions.Data_Miss[Region]++;
+    //A write-back belongs to the region of its victim line; with --tlb the victim is a physical address, mapped back to its page
+    if (Access_Result.Outcome == ACCESS_MISS_WRITE_BACK)
+    {
+        Address_Typedef Victim = TLB_Config.Enable ? Translate_Reverse(Access_Result.Victim_Address) : Access_Result.Victim_Address;
+        Regions.Write_Back[Region_Find(Victim, &Regions.Victim_Last)]++;
+    }
+}
+
+void Region_Invalidate(uint64_t address)
+{
+    if (Access_Result.Outcome == ACCESS_INVALIDATE_WRITE_BACK) Regions.Write_Back[Region_Find(address, &Regions.Victim_Last)]++;
+}
+
+void Region_Reset()
+{
+    if (Regions.Data_Hit != NULL) memset(Regions.Data_Hit, 0, 5 * (Regions.Count + 1) * sizeof(uint64_t));
+}
+
+void Region_Release()
+{
+    free(Regions.Region);
+    free(Regions.Base);
+    free(Regions.Limit);
+    free(Regions.Data_Hit);
+    memset(&Regions, 0, sizeof(Regions));
+}
+
+void Print_Region_Report()
+{
+    uint64_t Data;
+    uint64_t Instr;
+
+    printf("\033[36m\033[4;1m11. ADDRESS REGIONS:\n\033[0m\n");
+    printf("\033[36m\t   %-16s %-35s %12s %10s %12s %12s %10s\033[0m\n", "Region", "Range", "Data Access", "Miss Ratio", "Write Backs", "Fetches", "Miss Ratio");
+    for (uint32_t i = 0; i <= Regions.Count; i++)
+    {
+        char Range[48];
+        Data = Regions.Data_Hit[i] + Regions.Data_Miss[i];
+        Instr = Regions.Instr_Hit[i] + Regions.Instr_Miss[i];
+        //Unmapped addresses are only listed when there are some
+        if ((i == Regions.Count) && (Data + Instr + Regions.Write_Back[i] == 0)) break;
+        if (i < Regions.Count) snprintf(Range, sizeof(Range), "%" PRIx64 "-%" PRIx64, Regions.Base[i], Regions.Limit[i]);
+        else snprintf(Range, sizeof(Range), "-");
+        printf("\033[36m\t   %-16s %-35s %12" PRIu64 " %10.4f %12" PRIu64 " %12" PRIu64 " %10.4f\033[0m\n", Regions.Region[i].Name, Range,
+        Data, (Data == 0) ? 0.0 : (double) Regions.Data_Miss[i] / Data, Regions.Write_Back[i],
+        Instr, (Instr == 0) ? 0.0 : (double) Regions.Instr_Miss[i] / Instr);
+    }
+    printf("\n");
+}
+
+//Interval time series
+bool Interval_Open()
+{
+    if ((Interval_CSV = fopen(Interval_CSV_File, "w")) == NULL) return false;
+    fprintf(Interval_CSV, "window,end_access,end_cycle,accesses,hits,misses,write_backs,evictions,hit_ratio,miss_ratio_ewma,phase,phase_change\n");
+    Interval.Next = Interval.Length;
+    return true;
+}
+
+void Interval_Access()
+{
+    Interval.Total++;
+    Interval.Accesses++;
+    switch (Access_Result.Outcome)
+    {
+    case ACCESS_HIT:
+        Interval.Hits++;
+        break;
+
+    case ACCESS_MISS_WRITE_BACK:
+        Interval.Write_Backs++;
+        Interval.Evictions++;
+        Interval.Misses++;
+        break;
+
+    case ACCESS_MISS_EVICT:
+        Interval.Evictions++;
+        Interval.Misses++;
+        break;
+
+    default:
+        Interval.Misses++;
+        break;
+    }
+    if ((Interval.Cycles ? Sim_Cycle : Interval.Total) < Interval.Next) return;
+    Interval_Flush();
+    //A long stall may cross several cycle windows, they are merged into this one
+    Interval.Next = ((Interval.Cycles ? Sim_Cycle : Interval.Total) / Interval.Length + 1) * Interval.Length;
+}
+
+void Interval_Invalidate()
+{
+    if (Access_Result.Outcome == ACCESS_INVALIDATE_WRITE_BACK) Interval.Write_Backs++;
+}
+
+void Interval_Flush()
+{
+    double Miss_Ratio;
+    bool Change = false;
+
+    if (Interval.Accesses == 0) return;
+    Miss_Ratio = (double) Interval.Misses / Interval.Accesses;
+    if (Interval.Phase_Windows == 0)
+    {
+        Interval.Mean = Miss_Ratio;
+        Interval.Deviation = 0.0;
+    }
+    else
+    {
+        //Outside the band once the phase has settled: the window starts a new phase
+        double Shift = (Miss_Ratio > Interval.Mean) ? Miss_Ratio - Interval.Mean : Interval.Mean - Miss_Ratio;
+        Change = (Interval.Phase_Windows >= PHASE_WARMUP) && (Shift > PHASE_MIN_SHIFT) && (Shift > Interval.Threshold * Interval.Deviation);
+        if (Change)
+        {
+            Interval.Phase++;
+            Interval.Phase_Windows = 0;
+            Interval.Phase_Start = Interval.Total - Interval.Accesses;
+            Interval.Mean = Miss_Ratio;
+            Interval.Deviation = 0.0;
+        }
+        else
+        {
+            Interval.Deviation += PHASE_WEIGHT * (Shift - Interval.Deviation);
+            Interval.Mean += PHASE_WEIGHT * (Miss_Ratio - Interval.Mean);
+        }
+    }
+    Interval.Phase_Windows++;
+    fprintf(Interval_CSV, "%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.6f,%.6f,%u,%d\n",
+    Interval.Windows, Interval.Total, Sim_Cycle, Interval.Accesses, Interval.Hits, Interval.Misses, Interval.Write_Backs, Interval.Evictions,
+    (double) Interval.Hits / Interval.Accesses, Interval.Mean, Interval.Phase, Change);
+    Interval.Windows++;
+    Interval.Accesses = Interval.Hits = Interval.Misses = Interval.Write_Backs = Interval.Evictions = 0;
+}
+
+void Interval_Close()
+{
+    if (Interval_CSV == NULL) return;
+    //The last window is usually shorter
+    Interval_Flush();
+    fclose(Interval_CSV);
+    Interval_CSV = NULL;
+}
+
+void Print_Interval_Report()
+{
+    printf("\033[36m\033[4;1m12. INTERVALS AND PHASES:\n\033[0m\n");
+    printf("\033[36m\t+Windows: %" PRIu64 " of %" PRIu64 " %s, written to %s\n\t+Phase changes: %u, current phase since access %" PRIu64 " (miss ratio %1.4f)\033[0m\n\n",
+    Interval.Windows, Interval.Length, Interval.Cycles ? "cycles" : "accesses", Interval_CSV_File, Interval.Phase, Interval.Phase_Start, Interval.Mean);
+}
+
+//Early termination
+void Convergence_Access()
+{
+    uint64_t Data_Total = Data_Stats_Report.Data_Hit + Data_Stats_Report.Data_Miss;
+    uint64_t Instr_Total = Instr_Stats_Report.Instruction_Hit + Instr_Stats_Report.Instruction_Miss;
+    double Data_Ratio;
+    double Instr_Ratio;
+
+    if (++Convergence.Total < Convergence.Next) return;
+    Convergence.Next = Convergence.Total + Convergence.Window;
+    Data_Ratio = (Data_Total == 0) ? 0.0 : (double) Data_Stats_Report.Data_Hit / Data_Total;
+    Instr_Ratio = (Instr_Total == 0) ? 0.0 : (double) Instr_Stats_Report.Instruction_Hit / Instr_Total;
+    //A sample out of the band becomes the new reference, so a slow drift cannot pass for convergence
+    if (Convergence.Reference_Set && (Data_Ratio - Convergence.Data_Reference <= Convergence.Tolerance) && (Convergence.Data_Reference - Data_Ratio <= Convergence.Tolerance) &&
+    (Instr_Ratio - Convergence.Instr_Reference <= Convergence.Tolerance) && (Convergence.Instr_Reference - Instr_Ratio <= Convergence.Tolerance))
+    {
+        Convergence.Stable++;
+    }
+    else
+    {
+        Convergence.Reference_Set = true;
+        Convergence.Data_Reference = Data_Ratio;
+        Convergence.Instr_Reference = Instr_Ratio;
+        Convergence.Stable = 0;
+    }
+    if (Convergence.Stable < Convergence.Windows) return;
+    Convergence.Converged = true;
+    Convergence.Access = Convergence.Total;
+    Convergence.Data_Ratio = Data_Ratio;
+    Convergence.Instr_Ratio = Instr_Ratio;
+}
+
+void Convergence_Reset()
+{
+    Convergence.Reference_Set = false;
+    Convergence.Stable = 0;
+    Convergence.Next = Convergence.Total + Convergence.Window;
+}
+
+void Print_Convergence_Report()
+{
+    Convergence.Reported = Convergence.Total;
+    printf("\033[36m\033[4;1m13. CONVERGENCE:\n\033[0m\n");
+    if (Convergence.Converged)
+    {
+        printf("\033[36m\t+Converged after %" PRIu64 " line accesses: data hit ratio %1.4f, instruction hit ratio %1.4f (within %g for %u windows of %" PRIu64 ")\033[0m\n\n",
+        Convergence.Access, Convergence.Data_Ratio, Convergence.Instr_Ratio, Convergence.Tolerance, Convergence.Windows, Convergence.Window);
+    }
+    else
+    {
+        printf("\033[36m\t+Not converged after %" PRIu64 " line accesses, %u of %u stable windows\033[0m\n\n", Convergence.Total, Convergence.Stable, Convergence.Windows);
+    }
+}
+
+//Host hardware counters
+bool Host_Perf_Open()
+{
+#ifdef __linux__
+    const uint32_t Type[HOST_COUNTERS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+    const uint64_t Config[HOST_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    struct perf_event_attr Attribute;
+    uint32_t Opened = 0;
+
+    //User space of the calling thread only, so the default perf_event_paranoid level allows it
+    for (uint8_t i = 0; i < HOST_COUNTERS; i++)
+    {
+        memset(&Attribute, 0, sizeof(Attribute));
+        Attribute.size = sizeof(Attribute);
+        Attribute.type = Type[i];
+        Attribute.config = Config[i];
+        Attribute.exclude_kernel = 1;
+        Attribute.exclude_hv = 1;
+        Attribute.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        Host_Perf.Fd[i] = (int) syscall(SYS_perf_event_open, &Attribute, 0, -1, -1, 0);
+        if (Host_Perf.Fd[i] >= 0) Opened++;
+    }
+    if (Opened == 0)
+    {
+        printf("\033[33m   perf_event_open is not available, --perf is ignored\n\033[0m");
+        return false;
+    }
+    memset(Host_Perf.Report, 0, sizeof(Host_Perf.Report));
+    Host_Perf_Read(Host_Perf.Base);
+    return true;
+#else
+    printf("\033[33m   --perf needs Linux perf_event_open, it is ignored\n\033[0m");
+    return false;
+#endif
+}
+
+void Host_Perf_Read(uint64_t* Values)
+{
+    uint64_t Count[3]; //Value, time enabled, time running
+
+    for (uint8_t i = 0; i < HOST_COUNTERS; i++)
+    {
+        Values[i] = 0;
+        if ((Host_Perf.Fd[i] < 0) || (read(Host_Perf.Fd[i], Count, sizeof(Count)) != sizeof(Count))) continue;
+        //Counters multiplexed by the kernel are scaled to the whole time
+        Values[i] = ((Count[2] == 0) || (Count[2] >= Count[1])) ? Count[0] : (uint64_t)((double) Count[0] * Count[1] / Count[2]);
+    }
+}
+
+void Host_Perf_Simulation(uint64_t* Values)
+{
+    Host_Perf_Read(Values);
+    for (uint8_t i = 0; i < HOST_COUNTERS; i++) Values[i] -= Host_Perf.Base[i] + Host_Perf.Report[i];
+}
+
+void Host_Perf_Report_Begin()
+{
+    Host_Perf_Read(Host_Perf.Mark);
+}
+
+void Host_Perf_Report_End()
+{
+    uint64_t Now[HOST_COUNTERS];
+
+    Host_Perf_Read(Now);
+    for (uint8_t i = 0; i < HOST_COUNTERS; i++) Host_Perf.Report[i] += Now[i] - Host_Perf.Mark[i];
+}
+
+void Host_Perf_Close()
+{
+    for (uint8_t i = 0; i < HOST_COUNTERS; i++)
+    {
+        if (Host_Perf.Fd[i] >= 0) close(Host_Perf.Fd[i]);
+        Host_Perf.Fd[i] = -1;
+    }
+}
+
+void Print_Host_Perf_Report(bool Final)
+{
+    const char* Name[HOST_COUNTERS] = {"Cycles", "Instructions", "LLC Read Misses", "Branch Misses", "dTLB Read Misses"};
+    uint64_t Accesses = Data_Stats_Report.Data_Hit + Data_Stats_Report.Data_Miss + Instr_Stats_Report.Instruction_Hit + Instr_Stats_Report.Instruction_Miss;
+    uint64_t Simulation[HOST_COUNTERS];
+
+    if (Final)
+    {
+        if (Quiet) return;
+        Async_Log_Drain();
+        printf("\033[36m==============================================================================================================\033[0m\n");
+        printf("\033[36m\033[4;1mHOST COUNTERS AT THE END OF THE RUN (SIMULATION THREAD):\n\033[0m\n");
+    }
+    else printf("\033[36m\033[4;1m14. HOST COUNTERS (SIMULATION THREAD):\n\033[0m\n");
+    //Counts up to the start of this report; per access figures use the accesses since the last reset
+    if (Final) Host_Perf_Simulation(Simulation);
+    else for (uint8_t i = 0; i < HOST_COUNTERS; i++) Simulation[i] = Host_Perf.Mark[i] - Host_Perf.Base[i] - Host_Perf.Report[i];
+    printf("\033[36m\t   %-18s %16s %14s %16s\033[0m\n", "Counter", "Simulation", "Per Access", "Reports");
+    for (uint8_t i = 0; i < HOST_COUNTERS; i++)
+    {
+        if (Host_Perf.Fd[i] < 0)
+        {
+            printf("\033[36m\t   %-18s %16s\033[0m\n", Name[i], "n/a");
+            continue;
+        }
+        printf("\033[36m\t   %-18s %16" PRIu64 " %14.3f %16" PRIu64 "\033[0m\n", Name[i], Simulation[i],
+        (Accesses == 0) ? 0.0 : (double) Simulation[i] / Accesses, Host_Perf.Report[i]);
+    }
+    if ((Host_Perf.Fd[0] >= 0) && (Host_Perf.Fd[1] >= 0))
+    {
+        printf("\033[36m\t+IPC: %1.3f\033[0m\n", (Simulation[0] == 0) ? 0.0 : (double) Simulation[1] / Simulation[0]);
+    }
+    printf("\n");
+    if (Final) printf("\033[36m==============================================================================================================\033[0m\n");
+}
+
+//Trace sources
+bool Read_Trace_Header(FILE* fd, bool* Binary)
+{
+    Trace_File_Header_Typedef Header;
+    int First = getc(fd);
+
+    //Text traces start with an operation, a comment or a blank, 'L' can only open a binary trace
+    *Binary = (First == 'L');
+    if (First == EOF) return true;
+    if (*Binary == false) return ungetc(First, fd) != EOF;
+    Header.Magic[0] = (char) First;
+    if (fread((char*) &Header + 1, sizeof(Header) - 1, 1, fd) != 1) return false;
+    return (memcmp(Header.Magic, "L1TRACE", 8) == 0) && (Header.Version == TRACE_VERSION) && (Header.Record_Size == sizeof(Trace_Record_Typedef));
+}
+
+void Execute_Trace_Records(const Trace_Record_Typedef* Records, uint64_t Count)
+{
+    for (uint64_t i = 0; (i < Count) && (Convergence.Converged == false); i++)
+    {
+        Execute_Trace_Operation(Records[i].Operation, Records[i].Address, (Records[i].Size > 0) ? Records[i].Size : Default_Access_Size);
+    }
+}
+
+bool Run_Binary_Trace(FILE* fd)
+{
+    Trace_Record_Typedef* Records = (Trace_Record_Typedef*) malloc(TRACE_CHUNK * sizeof(Trace_Record_Typedef));
+    size_t Count;
+    bool Reported = false;
+
+    if (Records == NULL) return false;
+    while ((Convergence.Converged == false) && ((Count = fread(Records, sizeof(Trace_Record_Typedef), TRACE_CHUNK, fd)) > 0))
+    {
+        Execute_Trace_Records(Records, Count);
+        Reported = (Records[Count - 1].Operation == PRINT_LOG);
+    }
+    //A converted trace keeps its PRINT_LOG, a generated one ends with one like the hand-translated vectors
+    if ((Reported == false) && (Convergence.Converged == false)) Execute_Trace_Operation(PRINT_LOG, 0, 0);
+    free(Records);
+    return true;
+}
+
+bool Run_Generated_Trace()
+{
+    Trace_Record_Typedef* Records = (Trace_Record_Typedef*) calloc(TRACE_CHUNK, sizeof(Trace_Record_Typedef));
+    uint64_t Count;
+
+    if (Records == NULL) return false;
+    while ((Convergence.Converged == false) && ((Count = Generator_Fill(&Generator, Records, TRACE_CHUNK)) > 0)) Execute_Trace_Records(Records, Count);
+    //The patterns have no PRINT_LOG: the run ends with one like the hand-translated vectors
+    if (Convergence.Converged == false) Execute_Trace_Operation(PRINT_LOG, 0, 0);
+    free(Records);
+    return true;
+}
+
+bool Parse_Generator_Option(char* Option)
+{
+    char* Value = NULL;
+
+    if ((Value = Option_Value(Option, "--gen-count"))) Generator.Count = strtoull(Value, NULL, 0);
+    else if ((Value = Option_Value(Option, "--gen-base"))) Generator.Base = strtoull(Value, NULL, 0);
+    else if ((Value = Option_Value(Option, "--gen-footprint"))) Generator.Footprint = strtoull(Value, NULL, 0);
+    else if ((Value = Option_Value(Option, "--gen-stride"))) Generator.Stride = strtoull(Value, NULL, 0);
+    else if ((Value = Option_Value(Option, "--gen-code"))) Generator.Code_Size = strtoull(Value, NULL, 0);
+    else if ((Value = Option_Value(Option, "--gen-seed"))) Generator.Seed = strtoull(Value, NULL, 0);
+    else if ((Value = Option_Value(Option, "--gen-size"))) Generator.Size = strtoul(Value, NULL, 0);
+    else if ((Value = Option_Value(Option, "--gen-theta"))) Generator.Theta = strtod(Value, NULL);
+    else if ((Value = Option_Value(Option, "--gen-write"))) Generator.Write_Ratio = strtod(Value, NULL);
+    else if ((Value = Option_Value(Option, "--gen-fetch"))) Generator.Fetch_Ratio = strtod(Value, NULL);
+    else return false;
+    return true;
+}
+
+bool Generator_Select(char* Pattern)
+{
+    const char* Name[] = {"", "sequential", "stride", "random", "zipf", "chase", "mix"};
+    uint64_t Address_Limit = (ADDRESS_BIT < 64) ? (1ull << (ADDRESS_BIT & 63)) : 0;
+
+    Generator.Pattern = GEN_NONE;
+    for (uint8_t i = GEN_SEQUENTIAL; i <= GEN_MIX; i++)
+    {
+        if (!strcmp(Pattern, Name[i])) Generator.Pattern = i;
+    }
+    if (Generator.Pattern == GEN_NONE)
+    {
+        printf("\033[31mERROR: Unknown trace pattern %s (sequential, stride, random, zipf, chase or mix)\033[0m\n", Pattern);
+        return false;
+    }
+    if (Generator.Write_Ratio < 0.0) Generator.Write_Ratio = (Generator.Pattern == GEN_MIX) ? GEN_MIX_RATIO : 0.0;
+    if (Generator.Fetch_Ratio < 0.0) Generator.Fetch_Ratio = (Generator.Pattern == GEN_MIX) ? GEN_MIX_RATIO : 0.0;
+    if ((Generator.Footprint < 4 * LINE_SIZE) || ((Generator.Footprint >> BYTE_BIT) > UINT32_MAX) || (Generator.Code_Size < LINE_SIZE)
+    || ((Address_Limit > 0) && ((Generator.Base >= Address_Limit) || (Generator.Footprint > Address_Limit - Generator.Base) || (GEN_CODE_BASE + Generator.Code_Size > Address_Limit))))
+    {
+        printf("\033[31mERROR: The synthetic footprint needs 4 lines to 2^32 lines inside the %d-bit address space\033[0m\n", ADDRESS_BIT);
+        return false;
+    }
+    if ((Generator.Stride < 1) || (Generator.Stride > Generator.Footprint) || (Generator.Size > Generator.Footprint))
+    {
+        printf("\033[31mERROR: The stride and the access size must fit in the footprint\033[0m\n");
+        return false;
+    }
+    if ((Generator.Theta <= 0.0) || (Generator.Theta >= 1.0) || (Generator.Write_Ratio > 1.0) || (Generator.Fetch_Ratio > 1.0))
+    {
+        printf("\033[31mERROR: The Zipf skew must be between 0 and 1 (exclusive), the write and fetch ratios at most 1\033[0m\n");
+        return false;
+    }
+    return true;
+}
+
+bool Generator_Init(Trace_Generator_Typedef* Gen)
+{
+    uint64_t Other;
+    uint32_t Swap;
+
+    Gen->Done = Gen->Position = Gen->Code_Position = 0;
+    Gen->Lines = Gen->Footprint >> BYTE_BIT;
+    Gen->Step = (Gen->Pattern == GEN_STRIDE) ? Gen->Stride : ((Gen->Size > 0) ? Gen->Size : 4);
+    Gen->Random_State = (Gen->Seed + 1) * 0x9E3779B97F4A7C15ull;
+    Gen->Write_Threshold = (uint64_t)(Gen->Write_Ratio * 4294967296.0);
+    Gen->Fetch_Threshold = (uint64_t)(Gen->Fetch_Ratio * 4294967296.0);
+    if (Gen->Random_State == 0) Gen->Random_State = 1;
+    if (Gen->Pattern == GEN_CHASE)
+    {
+        //Sattolo's shuffle leaves a single cycle: the chase visits every line before it repeats
+        if ((Gen->Next_Line = (uint32_t*) malloc(Gen->Lines * sizeof(uint32_t))) == NULL) return false;
+        for (uint64_t i = 0; i < Gen->Lines; i++) Gen->Next_Line[i] = i;
+        for (uint64_t i = Gen->Lines - 1; i > 0; i--)
+        {
+            Other = Generator_Random(&Gen->Random_State) % i;
+            Swap = Gen->Next_Line[i];
+            Gen->Next_Line[i] = Gen->Next_Line[Other];
+            Gen->Next_Line[Other] = Swap;
+        }
+    }
+    if ((Gen->Pattern == GEN_ZIPF) || (Gen->Pattern == GEN_MIX)) return Generator_Zipf_Init(Gen);
+    return true;
+}
+
+void Generator_Release(Trace_Generator_Typedef* Gen)
+{
+    free(Gen->Next_Line);
+    free(Gen->Zipf_Table);
+    Gen->Next_Line = NULL;
+    Gen->Zipf_Table = NULL;
+}
+
+//xorshift64*
+ALWAYS_INLINE uint64_t Generator_Random(uint64_t* State)
+{
+    *State ^= *State >> 12;
+    *State ^= *State << 25;
+    *State ^= *State >> 27;
+    return *State * 0x2545F4914F6CDD1Dull;
+}
+
+//Natural logarithm without libm: ln(m * 2^e) = 2 atanh((m - 1) / (m + 1)) + e ln(2), m in [sqrt(2) / 2, sqrt(2)]
+double Generator_Log(double X)
+{
+    uint64_t Bits;
+    int Exponent;
+    const double Coefficient[11] = {1.0 / 3, 1.0 / 5, 1.0 / 7, 1.0 / 9, 1.0 / 11, 1.0 / 13, 1.0 / 15, 1.0 / 17, 1.0 / 19, 1.0 / 21, 1.0 / 23};
+    double Term, Square, Sum = 0.0;
+
+    if (X <= 0.0) return -1000.0;
+    memcpy(&Bits, &X, sizeof(Bits));
+    Exponent = (int)((Bits >> 52) & 0x7ff) - 1023;
+    Bits = (Bits & 0x000fffffffffffffull) | 0x3ff0000000000000ull;
+    memcpy(&X, &Bits, sizeof(X));
+    if (X > 1.41421356237309504880)
+    {
+        X *= 0.5;
+        Exponent++;
+    }
+    Term = (X - 1.0) / (X + 1.0);
+    Square = Term * Term;
+    //Horner form of Term + Term^3 / 3 + ... + Term^23 / 23
+    for (int i = 10; i >= 0; i--) Sum = (Sum + Coefficient[i]) * Square;
+    return 2.0 * Term * (1.0 + Sum) + Exponent * 0.69314718055994530942;
+}
+
+//e^X = 2^k e^r with |r| <= ln(2) / 2
+double Generator_Exp(double X)
+{
+    int64_t Exponent;
+    uint64_t Bits;
+    const double Coefficient[14] = {1.0, 1.0 / 2, 1.0 / 3, 1.0 / 4, 1.0 / 5, 1.0 / 6, 1.0 / 7, 1.0 / 8, 1.0 / 9, 1.0 / 10, 1.0 / 11, 1.0 / 12, 1.0 / 13, 1.0 / 14};
+    double Scale, Sum = 1.0;
+
+    if (X < -700.0) return 0.0;
+    if (X > 700.0) X = 700.0;
+    Exponent = (int64_t)(X * 1.44269504088896340736 + ((X < 0.0) ? -0.5 : 0.5));
+    X -= Exponent * 0.69314718055994530942;
+    //Horner form of 1 + X + X^2 / 2! + ... + X^14 / 14!
+    for (int i = 13; i >= 0; i--) Sum = 1.0 + Sum * X * Coefficient[i];
+    Bits = (uint64_t)(Exponent + 1023) << 52;
+    memcpy(&Scale, &Bits, sizeof(Scale));
+    return Sum * Scale;
+}
+
+double Generator_Power(double X, double Y)
+{
+    return (X <= 0.0) ? 0.0 : Generator_Exp(Y * Generator_Log(X));
+}
+
+//Alias table of rank^-Theta, built once: the draws need no logarithm or power
+bool Generator_Zipf_Init(Trace_Generator_Typedef* Gen)
+{
+    uint64_t Rank;
+    uint64_t Ranks;
+    uint32_t Entries = 0;
+    uint32_t Small_Count = 0;
+    uint32_t Large_Count = 0;
+    uint32_t Small;
+    uint32_t Large;
+    double* Weight;
+    uint32_t* Work;
+    double Total = 0.0;
+
+    for (Rank = 0; Rank < Gen->Lines; Rank += Ranks, Entries++) Ranks = (Rank < GEN_ZIPF_GROWTH) ? 1 : Rank / GEN_ZIPF_GROWTH;
+    Gen->Zipf_Table = (Zipf_Entry_Typedef*) malloc(Entries * sizeof(Zipf_Entry_Typedef));
+    Weight = (double*) malloc(Entries * sizeof(double));
+    Work = (uint32_t*) malloc(Entries * sizeof(uint32_t));
+    if ((Gen->Zipf_Table == NULL) || (Weight == NULL) || (Work == NULL))
+    {
+        free(Weight);
+        free(Work);
+        return false;
+    }
+    Gen->Zipf_Entries = Entries;
+    //Rank r has weight (r + 1)^-Theta; a run of ranks takes the integral over their unit intervals
+    Rank = 0;
+    for (uint32_t i = 0; i < Entries; i++, Rank += Ranks)
+    {
+        Ranks = (Rank < GEN_ZIPF_GROWTH) ? 1 : Rank / GEN_ZIPF_GROWTH;
+        if (Ranks > Gen->Lines - Rank) Ranks = Gen->Lines - Rank;
+        Gen->Zipf_Table[i].First = Rank;
+        Gen->Zipf_Table[i].Ranks = Ranks;
+        if (Ranks == 1) Weight[i] = Generator_Power(Rank + 1.0, -Gen->Theta);
+        else Weight[i] = (Generator_Power(Rank + Ranks + 0.5, 1.0 - Gen->Theta) - Generator_Power(Rank + 0.5, 1.0 - Gen->Theta)) / (1.0 - Gen->Theta);
+        Total += Weight[i];
+    }
+    //Vose: small entries are topped up by large ones, Work holds the small ones from the start and the large ones from the end
+    for (uint32_t i = 0; i < Entries; i++)
+    {
+        Weight[i] *= Entries / Total;
+        if (Weight[i] < 1.0) Work[Small_Count++] = i;
+        else Work[Entries - ++Large_Count] = i;
+    }
+    while ((Small_Count > 0) && (Large_Count > 0))
+    {
+        Small = Work[--Small_Count];
+        Large = Work[Entries - Large_Count--];
+        Gen->Zipf_Table[Small].Threshold = (uint32_t)(Weight[Small] * (1u << GEN_ALIAS_BIT));
+        Gen->Zipf_Table[Small].Alias = Large;
+        Weight[Large] -= 1.0 - Weight[Small];
+        if (Weight[Large] < 1.0) Work[Small_Count++] = Large;
+        else Work[Entries - ++Large_Count] = Large;
+    }
+    //The rest is 1 up to rounding
+    while (Small_Count > 0) Gen->Zipf_Table[Work[--Small_Count]].Threshold = 1u << GEN_ALIAS_BIT;
+    while (Large_Count > 0) Gen->Zipf_Table[Work[Entries - Large_Count--]].Threshold = 1u << GEN_ALIAS_BIT;
+    free(Weight);
+    free(Work);
+    return true;
+}
+
+//Line of a Zipf draw: the high 32 bits pick the entry, the next ones decide on the alias
+ALWAYS_INLINE uint64_t Generator_Zipf(Trace_Generator_Typedef* Gen, uint64_t Random)
+{
+    uint32_t Index = ((Random >> 32) * Gen->Zipf_Entries) >> 32;
+    uint32_t Alias = Gen->Zipf_Table[Index].Alias;
+    uint64_t Rank;
+
+    //Masked rather than branched: the outcome is a coin toss the predictor cannot learn
+    Index ^= (Index ^ Alias) & -(uint32_t)(((Random >> 6) & ((1u << GEN_ALIAS_BIT) - 1)) >= Gen->Zipf_Table[Index].Threshold);
+    Rank = Gen->Zipf_Table[Index].First + (((Generator_Random(&Gen->Random_State) >> 32) * Gen->Zipf_Table[Index].Ranks) >> 32);
+    return (Rank * GEN_SCRAMBLE) % Gen->Lines;
+}
+
+uint64_t Generator_Fill(Trace_Generator_Typedef* Gen, Trace_Record_Typedef* Records, uint64_t Count)
+{
+    uint64_t Random;
+    uint64_t Line;
+
+    if (Count > Gen->Count - Gen->Done) Count = Gen->Count - Gen->Done;
+    for (uint64_t i = 0; i < Count; i++)
+    {
+        Random = Generator_Random(&Gen->Random_State);
+        Records[i].Size = Gen->Size;
+        if ((Random >> 32) < Gen->Fetch_Threshold)
+        {
+            //Straight-line code with a taken branch every 16 instructions on average
+            if ((Random & 15) == 0) Gen->Code_Position = ((Random >> 4) % Gen->Code_Size) & ~3ull;
+            else if ((Gen->Code_Position += 4) >= Gen->Code_Size) Gen->Code_Position = 0;
+            Records[i].Operation = FETCH;
+            Records[i].Address = GEN_CODE_BASE + Gen->Code_Position;
+            continue;
+        }
+        Records[i].Operation = ((Random & UINT32_MAX) < Gen->Write_Threshold) ? WRITE : READ;
+        Random = Generator_Random(&Gen->Random_State);
+        switch (Gen->Pattern)
+        {
+        case GEN_SEQUENTIAL:
+        case GEN_STRIDE:
+            Records[i].Address = Gen->Base + Gen->Position;
+            if ((Gen->Position += Gen->Step) >= Gen->Footprint) Gen->Position -= Gen->Footprint;
+            continue;
+
+        case GEN_RANDOM:
+            Line = ((Random >> 32) * Gen->Lines) >> 32;
+            break;
+
+        case GEN_CHASE:
+            //The pointer sits at the start of each node
+            Line = Gen->Position = Gen->Next_Line[Gen->Position];
+            Random = 0;
+            break;
+
+        default:
+            Line = Generator_Zipf(Gen, Random);
+            break;
+        }
+        Records[i].Address = Gen->Base + (Line << BYTE_BIT) + (Random & BYTE_MASK & ~3u);
+    }
+    Gen->Done += Count;
+    return Count;
+}
+
+//RV32I programs
+bool RV_Source_File(const char* Trace_File)
+{
+    size_t Length = (Trace_File != NULL) ? strlen(Trace_File) : 0;
+
+    return (Length > 2) && (Trace_File[Length - 2] == '.') && ((Trace_File[Length - 1] == 's') || (Trace_File[Length - 1] == 'S'));
+}
+
+bool RV_Run_Program(FILE* fd)
+{
+    bool OK;
+
+    memset(&RV_Machine.Register, 0, sizeof(RV_Machine.Register));
+    RV_Machine.PC = 0;
+    RV_Machine.Steps = 0;
+    RV_Machine.Fault = false;
+    OK = Hash_Map_Init(&RV_Machine.Page_Index, 64) && RV_Assemble(&RV_Machine, fd);
+    if (OK)
+    {
+        RV_Run(&RV_Machine);
+        if (Quiet == false) printf("\033[32m   RV32I program: %" PRIu64 " instructions, stopped at PC 0x%08" PRIx32 "\033[0m\n", RV_Machine.Steps, RV_Machine.PC);
+        //Like the hand-translated vectors, the program ends with a PRINT_LOG
+        if (Convergence.Converged == false) Execute_Trace_Operation(PRINT_LOG, 0, 0);
+    }
+    OK = OK && (RV_Machine.Fault == false);
+    RV_Release(&RV_Machine);
+    return OK;
+}
+
+//Two passes: the first places the labels, the second encodes the code into memory and decodes it for the interpreter
+bool RV_Assemble(RV_Machine_Typedef* Machine, FILE* fd)
+{
+    char one_line[MAX_TRACES];
+    char Source[MAX_TRACES];
+    uint32_t PC;
+    uint32_t Line;
+
+    for (uint8_t Pass = 0; Pass < 2; Pass++)
+    {
+        PC = 0;
+        Line = 0;
+        rewind(fd);
+        while (fgets(one_line, MAX_TRACES, fd) != NULL)
+        {
+            Line++;
+            strcpy(Source, one_line);
+            if (RV_Assemble_Line(Machine, one_line, Pass == 1, &PC) == false)
+            {
+                printf("\033[31mERROR: Line %u of %s: cannot assemble %s\033[0m\n", Line, Trace_Name, strtok(Source, "\r\n"));
+                return false;
+            }
+        }
+        if (Pass == 0)
+        {
+            Machine->Words = PC / 4;
+            if ((Machine->Code = (RV_Instruction_Typedef*) calloc(Machine->Words + 1, sizeof(RV_Instruction_Typedef))) == NULL) return false;
+        }
+    }
+    return true;
+}
+
+bool RV_Assemble_Line(RV_Machine_Typedef* Machine, char* Line, bool Emit, uint32_t* PC)
+{
+    char* Token[RV_TOKENS];
+    char* Cursor = Line;
+    int Count = 0;
+    int Operands;
+    uint8_t Opcode = RV_INSTRUCTIONS;
+    uint8_t Register[3] = {0, 0, 0};
+    int64_t Imm = 0;
+    uint32_t Value;
+    size_t Length;
+
+    //Comments start with '#', ';' or "//", commas and parentheses only separate operands
+    for (; *Cursor != '\0'; Cursor++)
+    {
+        if ((*Cursor == '#') || (*Cursor == ';') || ((Cursor[0] == '/') && (Cursor[1] == '/')))
+        {
+            *Cursor = '\0';
+            break;
+        }
+        if ((*Cursor == ',') || (*Cursor == '(') || (*Cursor == ')')) *Cursor = ' ';
+    }
+    for (Cursor = Line; Count < RV_TOKENS; )
+    {
+        Cursor += strspn(Cursor, " \t\r\n");
+        if (*Cursor == '\0') break;
+        Token[Count++] = Cursor;
+        Cursor += strcspn(Cursor, " \t\r\n");
+        if (*Cursor != '\0') *Cursor++ = '\0';
+    }
+    //Labels, then the directives are skipped
+    while ((Count > 0) && ((Length = strlen(Token[0])) > 1) && (Token[0][Length - 1] == ':'))
+    {
+        Token[0][Length - 1] = '\0';
+        if ((Emit == false) && ((Length > RV_LABEL) || RV_Target(Machine, Token[0], true, 0, &Imm))) return false;
+        if (Emit == false)
+        {
+            Machine->Label = (RV_Label_Typedef*) realloc(Machine->Label, (Machine->Labels + 1) * sizeof(RV_Label_Typedef));
+            strcpy(Machine->Label[Machine->Labels].Name, Token[0]);
+            Machine->Label[Machine->Labels++].Address = *PC;
+        }
+        for (int i = 1; i < Count; i++) Token[i - 1] = Token[i];
+        Count--;
+    }
+    if ((Count == 0) || (Token[0][0] == '.')) return true;
+    Operands = Count - 1;
+    //Pseudo-instructions
+    if (!strcmp(Token[0], "nop")) return (Operands == 0) && RV_Emit(Machine, Emit, PC, RV_ADDI, 0, 0, 0, 0);
+    if (!strcmp(Token[0], "mv") || !strcmp(Token[0], "not") || !strcmp(Token[0], "neg") || !strcmp(Token[0], "seqz") || !strcmp(Token[0], "snez"))
+    {
+        if ((Operands != 2) || !RV_Register(Token[1], &Register[0]) || !RV_Register(Token[2], &Register[1])) return false;
+        if (!strcmp(Token[0], "mv")) return RV_Emit(Machine, Emit, PC, RV_ADDI, Register[0], Register[1], 0, 0);
+        if (!strcmp(Token[0], "not")) return RV_Emit(Machine, Emit, PC, RV_XORI, Register[0], Register[1], 0, -1);
+        if (!strcmp(Token[0], "neg")) return RV_Emit(Machine, Emit, PC, RV_SUB, Register[0], 0, Register[1], 0);
+        if (!strcmp(Token[0], "seqz")) return RV_Emit(Machine, Emit, PC, RV_SLTIU, Register[0], Register[1], 0, 1);
+        return RV_Emit(Machine, Emit, PC, RV_SLTU, Register[0], 0, Register[1], 0);
+    }
+    if (!strcmp(Token[0], "li"))
+    {
+        if ((Operands != 2) || !RV_Register(Token[1], &Register[0]) || !RV_Immediate(Token[2], &Imm) || (Imm < INT32_MIN) || (Imm > UINT32_MAX)) return false;
+        if ((Imm >= -2048) && (Imm < 2048)) return RV_Emit(Machine, Emit, PC, RV_ADDI, Register[0], 0, 0, Imm);
+        //lui takes the upper bits rounded so that the sign-extended lower 12 bits add up to the value
+        Value = (uint32_t) Imm;
+        if (RV_Emit(Machine, Emit, PC, RV_LUI, Register[0], 0, 0, ((Value + 0x800) >> 12) & 0xfffff) == false) return false;
+        return ((Value & 0xfff) == 0) || RV_Emit(Machine, Emit, PC, RV_ADDI, Register[0], Register[0], 0, RV_Sign_Extend(Value & 0xfff, 12));
+    }
+    if (!strcmp(Token[0], "la"))
+    {
+        if ((Operands != 2) || !RV_Register(Token[1], &Register[0]) || !RV_Target(Machine, Token[2], Emit, *PC, &Imm)) return false;
+        Value = (uint32_t) Imm;
+        return RV_Emit(Machine, Emit, PC, RV_AUIPC, Register[0], 0, 0, ((Value + 0x800) >> 12) & 0xfffff)
+        && RV_Emit(Machine, Emit, PC, RV_ADDI, Register[0], Register[0], 0, RV_Sign_Extend(Value & 0xfff, 12));
+    }
+    if (!strcmp(Token[0], "j") || !strcmp(Token[0], "call"))
+    {
+        if ((Operands != 1) || !RV_Target(Machine, Token[1], Emit, *PC, &Imm)) return false;
+        return RV_Emit(Machine, Emit, PC, RV_JAL, (Token[0][0] == 'j') ? 0 : 1, 0, 0, Imm);
+    }
+    if (!strcmp(Token[0], "ret")) return (Operands == 0) && RV_Emit(Machine, Emit, PC, RV_JALR, 0, 1, 0, 0);
+    if (!strcmp(Token[0], "jr")) return (Operands == 1) && RV_Register(Token[1], &Register[1]) && RV_Emit(Machine, Emit, PC, RV_JALR, 0, Register[1], 0, 0);
+    if (!strcmp(Token[0], "beqz") || !strcmp(Token[0], "bnez") || !strcmp(Token[0], "bltz") || !strcmp(Token[0], "bgez") || !strcmp(Token[0], "blez") || !strcmp(Token[0], "bgtz"))
+    {
+        if ((Operands != 2) || !RV_Register(Token[1], &Register[0]) || !RV_Target(Machine, Token[2], Emit, *PC, &Imm)) return false;
+        if (!strcmp(Token[0], "beqz")) return RV_Emit(Machine, Emit, PC, RV_BEQ, 0, Register[0], 0, Imm);
+        if (!strcmp(Token[0], "bnez")) return RV_Emit(Machine, Emit, PC, RV_BNE, 0, Register[0], 0, Imm);
+        if (!strcmp(Token[0], "bltz")) return RV_Emit(Machine, Emit, PC, RV_BLT, 0, Register[0], 0, Imm);
+        if (!strcmp(Token[0], "bgez")) return RV_Emit(Machine, Emit, PC, RV_BGE, 0, Register[0], 0, Imm);
+        if (!strcmp(Token[0], "blez")) return RV_Emit(Machine, Emit, PC, RV_BGE, 0, 0, Register[0], Imm);
+        return RV_Emit(Machine, Emit, PC, RV_BLT, 0, 0, Register[0], Imm);
+    }
+    if (!strcmp(Token[0], "bgt") || !strcmp(Token[0], "ble") || !strcmp(Token[0], "bgtu") || !strcmp(Token[0], "bleu"))
+    {
+        //Swapped operands of blt, bge, bltu and bgeu
+        if ((Operands != 3) || !RV_Register(Token[1], &Register[0]) || !RV_Register(Token[2], &Register[1]) || !RV_Target(Machine, Token[3], Emit, *PC, &Imm)) return false;
+        Opcode = !strcmp(Token[0], "bgt") ? RV_BLT : !strcmp(Token[0], "ble") ? RV_BGE : !strcmp(Token[0], "bgtu") ? RV_BLTU : RV_BGEU;
+        return RV_Emit(Machine, Emit, PC, Opcode, 0, Register[1], Register[0], Imm);
+    }
+    //Base instructions
+    for (uint8_t i = 0; i < RV_INSTRUCTIONS; i++)
+    {
+        if (!strcmp(Token[0], RV_Encoding[i].Name)) Opcode = i;
+    }
+    if (Opcode == RV_INSTRUCTIONS) return false;
+    switch (RV_Encoding[Opcode].Format)
+    {
+    case RV_FORMAT_R:
+        if ((Operands != 3) || !RV_Register(Token[1], &Register[0]) || !RV_Register(Token[2], &Register[1]) || !RV_Register(Token[3], &Register[2])) return false;
+        break;
+
+    case RV_FORMAT_I:
+    case RV_FORMAT_SHIFT:
+        if ((Operands != 3) || !RV_Register(Token[1], &Register[0]) || !RV_Register(Token[2], &Register[1]) || !RV_Immediate(Token[3], &Imm)) return false;
+        break;
+
+    case RV_FORMAT_LOAD:
+    case RV_FORMAT_STORE:
+    case RV_FORMAT_JALR:
+        //"rd, imm(rs1)", "rd, (rs1)", "rd, rs1, imm" (jalr) or "rs1" (jalr, rd = ra)
+        if ((RV_Encoding[Opcode].Format == RV_FORMAT_JALR) && (Operands == 1) && RV_Register(Token[1], &Register[1])) Register[0] = 1;
+        else if ((Operands == 2) && RV_Register(Token[1], &Register[0]) && RV_Register(Token[2], &Register[1])) Imm = 0;
+        else if ((Operands != 3) || !RV_Register(Token[1], &Register[0])) return false;
+        else if (RV_Register(Token[2], &Register[1]) && (RV_Encoding[Opcode].Format == RV_FORMAT_JALR)) return RV_Immediate(Token[3], &Imm) && RV_Emit(Machine, Emit, PC, Opcode, Register[0], Register[1], 0, Imm);
+        else if (!RV_Immediate(Token[2], &Imm) || !RV_Register(Token[3], &Register[1])) return false;
+        //Stores name rs2 first
+        if (RV_Encoding[Opcode].Format == RV_FORMAT_STORE) return RV_Emit(Machine, Emit, PC, Opcode, 0, Register[1], Register[0], Imm);
+        break;
+
+    case RV_FORMAT_BRANCH:
+        if ((Operands != 3) || !RV_Register(Token[1], &Register[1]) || !RV_Register(Token[2], &Register[2]) || !RV_Target(Machine, Token[3], Emit, *PC, &Imm)) return false;
+        break;
+
+    case RV_FORMAT_U:
+        if ((Operands != 2) || !RV_Register(Token[1], &Register[0]) || !RV_Immediate(Token[2], &Imm)) return false;
+        break;
+
+    case RV_FORMAT_J:
+        //"jal label" links in ra
+        if ((Operands == 1) && RV_Target(Machine, Token[1], Emit, *PC, &Imm)) Register[0] = 1;
+        else if ((Operands != 2) || !RV_Register(Token[1], &Register[0]) || !RV_Target(Machine, Token[2], Emit, *PC, &Imm)) return false;
+        break;
+
+    default:
+        //The operands of fence are ignored, it runs as a nop
+        if ((Operands > 0) && (Opcode != RV_FENCE)) return false;
+        break;
+    }
+    return RV_Emit(Machine, Emit, PC, Opcode, Register[0], Register[1], Register[2], Imm);
+}
+
+bool RV_Register(const char* Token, uint8_t* Register)
+{
+    const char* Name[32] = {"zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2", "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"};
+    char* End;
+    unsigned long Number;
+
+    if ((Token[0] == 'x') && (Token[1] >= '0') && (Token[1] <= '9'))
+    {
+        Number = strtoul(&Token[1], &End, 10);
+        if ((*End != '\0') || (Number > 31)) return false;
+        *Register = Number;
+        return true;
+    }
+    if (!strcmp(Token, "fp"))
+    {
+        *Register = 8;
+        return true;
+    }
+    for (uint8_t i = 0; i < 32; i++)
+    {
+        if (!strcmp(Token, Name[i]))
+        {
+            *Register = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RV_Immediate(const char* Token, int64_t* Value)
+{
+    char* End;
+
+    *Value = strtoll(Token, &End, 0);
+    return (End != Token) && (*End == '\0');
+}
+
+//Branch and jump targets: a label, or a byte offset from the instruction; unknown labels pass the first pass
+bool RV_Target(RV_Machine_Typedef* Machine, const char* Token, bool Emit, uint32_t PC, int64_t* Offset)
+{
+    for (uint32_t i = 0; i < Machine->Labels; i++)
+    {
+        if (!strcmp(Token, Machine->Label[i].Name))
+        {
+            *Offset = (int64_t) Machine->Label[i].Address - PC;
+            return true;
+        }
+    }
+    if (RV_Immediate(Token, Offset)) return true;
+    *Offset = 0;
+    return Emit == false;
+}
+
+bool RV_Emit(RV_Machine_Typedef* Machine, bool Emit, uint32_t* PC, uint8_t Opcode, uint8_t Rd, uint8_t Rs1, uint8_t Rs2, int64_t Imm)
+{
+    uint32_t Word;
+    bool Fit;
+
+    if (Emit)
+    {
+        switch (RV_Encoding[Opcode].Format)
+        {
+        case RV_FORMAT_I:
+        case RV_FORMAT_LOAD:
+        case RV_FORMAT_STORE:
+        case RV_FORMAT_JALR:
+            Fit = (Imm >= -2048) && (Imm < 2048);
+            break;
+
+        case RV_FORMAT_SHIFT:
+            Fit = (Imm >= 0) && (Imm < 32);
+            break;
+
+        case RV_FORMAT_BRANCH:
+            Fit = (Imm >= -4096) && (Imm < 4096) && ((Imm & 1) == 0);
+            break;
+
+        case RV_FORMAT_U:
+            Fit = (Imm >= 0) && (Imm <= 0xfffff);
+            break;
+
+        case RV_FORMAT_J:
+            Fit = (Imm >= -(1 << 20)) && (Imm < (1 << 20)) && ((Imm & 1) == 0);
+            break;
+
+        default:
+            Fit = true;
+            break;
+        }
+        if (Fit == false) return false;
+        Word = RV_Encode(Opcode, Rd, Rs1, Rs2, (int32_t) Imm);
+        RV_Store(Machine, *PC, Word, 4);
+        if (RV_Decode(Word, &Machine->Code[*PC / 4]) == false) return false;
+    }
+    *PC += 4;
+    return true;
+}
+
+uint32_t RV_Encode(uint8_t Opcode, uint8_t Rd, uint8_t Rs1, uint8_t Rs2, int32_t Imm)
+{
+    const RV_Encoding_Typedef* Encoding = &RV_Encoding[Opcode];
+    uint32_t Value = (uint32_t) Imm;
+    uint32_t Word = Encoding->Opcode | ((uint32_t) Encoding->Funct3 << 12);
+
+    switch (Encoding->Format)
+    {
+    case RV_FORMAT_R:
+        return Word | ((uint32_t) Rd << 7) | ((uint32_t) Rs1 << 15) | ((uint32_t) Rs2 << 20) | ((uint32_t) Encoding->Funct7 << 25);
+
+    case RV_FORMAT_SHIFT:
+        return Word | ((uint32_t) Rd << 7) | ((uint32_t) Rs1 << 15) | ((Value & 31) << 20) | ((uint32_t) Encoding->Funct7 << 25);
+
+    case RV_FORMAT_STORE:
+        return Word | ((Value & 31) << 7) | ((uint32_t) Rs1 << 15) | ((uint32_t) Rs2 << 20) | (((Value >> 5) & 0x7f) << 25);
+
+    case RV_FORMAT_BRANCH:
+        return Word | (((Value >> 11) & 1) << 7) | (((Value >> 1) & 0xf) << 8) | ((uint32_t) Rs1 << 15) | ((uint32_t) Rs2 << 20)
+        | (((Value >> 5) & 0x3f) << 25) | (((Value >> 12) & 1) << 31);
+
+    case RV_FORMAT_U:
+        return Word | ((uint32_t) Rd << 7) | (Value << 12);
+
+    case RV_FORMAT_J:
+        return Word | ((uint32_t) Rd << 7) | (Value & 0xff000) | (((Value >> 11) & 1) << 20) | (((Value >> 1) & 0x3ff) << 21) | (((Value >> 20) & 1) << 31);
+
+    case RV_FORMAT_SYSTEM:
+        return Encoding->Opcode | ((uint32_t) Encoding->Funct7 << 20);
+
+    default:
+        return Word | ((uint32_t) Rd << 7) | ((uint32_t) Rs1 << 15) | ((Value & 0xfff) << 20);
+    }
+}
+
+bool RV_Decode(uint32_t Word, RV_Instruction_Typedef* Instruction)
+{
+    const RV_Encoding_Typedef* Encoding;
+    uint8_t Funct3 = (Word >> 12) & 7;
+    uint8_t Funct7 = Word >> 25;
+
+    Instruction->Rd = (Word >> 7) & 31;
+    Instruction->Rs1 = (Word >> 15) & 31;
+    Instruction->Rs2 = (Word >> 20) & 31;
+    for (uint8_t i = 0; i < RV_INSTRUCTIONS; i++)
+    {
+        Encoding = &RV_Encoding[i];
+        if (Encoding->Opcode != (Word & 0x7f)) continue;
+        if (((Encoding->Format == RV_FORMAT_R) || (Encoding->Format == RV_FORMAT_SHIFT)) && (Funct7 != Encoding->Funct7)) continue;
+        if ((Encoding->Format == RV_FORMAT_SYSTEM) && (Encoding->Opcode == 0x73) && ((Word >> 7) != ((uint32_t) Encoding->Funct7 << 13))) continue;
+        if ((Encoding->Format != RV_FORMAT_U) && (Encoding->Format != RV_FORMAT_J) && (Encoding->Format != RV_FORMAT_SYSTEM) && (Funct3 != Encoding->Funct3)) continue;
+        Instruction->Opcode = i;
+        switch (Encoding->Format)
+        {
+        case RV_FORMAT_SHIFT:
+            Instruction->Imm = (Word >> 20) & 31;
+            break;
+
+        case RV_FORMAT_STORE:
+            Instruction->Imm = RV_Sign_Extend(((Word >> 25) << 5) | ((Word >> 7) & 31), 12);
+            break;
+
+        case RV_FORMAT_BRANCH:
+            Instruction->Imm = RV_Sign_Extend(((Word >> 31) << 12) | (((Word >> 7) & 1) << 11) | (((Word >> 25) & 0x3f) << 5) | (((Word >> 8) & 0xf) << 1), 13);
+            break;
+
+        case RV_FORMAT_U:
+            Instruction->Imm = (int32_t)(Word & 0xfffff000);
+            break;
+
+        case RV_FORMAT_J:
+            Instruction->Imm = RV_Sign_Extend(((Word >> 31) << 20) | (Word & 0xff000) | (((Word >> 20) & 1) << 11) | (((Word >> 21) & 0x3ff) << 1), 21);
+            break;
+
+        case RV_FORMAT_R:
+        case RV_FORMAT_SYSTEM:
+            Instruction->Imm = 0;
+            break;
+
+        default:
+            Instruction->Imm = RV_Sign_Extend(Word >> 20, 12);
+            break;
+        }
+        return true;
+    }
+    return false;
+}
+
+int32_t RV_Sign_Extend(uint32_t Value, uint8_t Bits)
+{
+    return (int32_t)(Value << (32 - Bits)) >> (32 - Bits);
+}
+
+uint8_t* RV_Page(RV_Machine_Typedef* Machine, uint32_t Address)
+{
+    uint32_t Number = Address >> RV_PAGE_BIT;
+    uint64_t Index;
+
+    if ((Machine->Last_Page != NULL) && (Number == Machine->Last_Number)) return Machine->Last_Page;
+    if (Hash_Map_Find(&Machine->Page_Index, Number, &Index) == false)
+    {
+        Index = Machine->Pages;
+        Machine->Page = (uint8_t**) realloc(Machine->Page, (Machine->Pages + 1) * sizeof(uint8_t*));
+        if ((Machine->Page == NULL) || ((Machine->Page[Index] = (uint8_t*) calloc(1u << RV_PAGE_BIT, 1)) == NULL)
+        || (Hash_Map_Insert(&Machine->Page_Index, Number, Index) == false))
+        {
+            printf("\033[31mERROR: Cannot allocate the memory of the RV32I program\033[0m\n");
+            Machine->Fault = true;
+            return NULL;
+        }
+        Machine->Pages++;
+    }
+    Machine->Last_Number = Number;
+    Machine->Last_Page = Machine->Page[Index];
+    return Machine->Last_Page;
+}
+
+//Little-endian, misaligned accesses allowed
+uint32_t RV_Load(RV_Machine_Typedef* Machine, uint32_t Address, uint8_t Size)
+{
+    uint32_t Value = 0;
+    uint8_t* Page;
+
+    for (uint8_t i = 0; i < Size; i++, Address++)
+    {
+        if ((Page = RV_Page(Machine, Address)) == NULL) return 0;
+        Value |= (uint32_t) Page[Address & RV_PAGE_MASK] << (8 * i);
+    }
+    return Value;
+}
+
+void RV_Store(RV_Machine_Typedef* Machine, uint32_t Address, uint32_t Value, uint8_t Size)
+{
+    uint8_t* Page;
+
+    for (uint8_t i = 0; i < Size; i++, Address++, Value >>= 8)
+    {
+        if ((Page = RV_Page(Machine, Address)) == NULL) return;
+        Page[Address & RV_PAGE_MASK] = (uint8_t) Value;
+    }
+}
+
+//Every instruction is fetched through the instruction cache, loads and stores go to the data cache
+void RV_Run(RV_Machine_Typedef* Machine)
+{
+    RV_Instruction_Typedef* Instruction;
+    uint32_t* X = Machine->Register;
+    uint32_t PC;
+    uint32_t Next;
+    uint32_t Address;
+
+    while ((Convergence.Converged == false) && (Machine->Fault == false) && ((Machine->Max_Steps == 0) || (Machine->Steps < Machine->Max_Steps)))
+    {
+        PC = Machine->PC;
+        //The program ends when it leaves the code
+        if ((PC / 4) >= Machine->Words) break;
+        if (PC & 3)
+        {
+            printf("\033[31mERROR: Misaligned RV32I PC 0x%08" PRIx32 "\033[0m\n", PC);
+            Machine->Fault = true;
+            break;
+        }
+        Instruction = &Machine->Code[PC / 4];
+        Execute_Trace_Operation(FETCH, PC, 4);
+        Machine->Steps++;
+        Next = PC + 4;
+        switch (Instruction->Opcode)
+        {
+        case RV_LUI:    X[Instruction->Rd] = Instruction->Imm; break;
+        case RV_AUIPC:  X[Instruction->Rd] = PC + Instruction->Imm; break;
+        case RV_JAL:
+            X[Instruction->Rd] = Next;
+            Next = PC + Instruction->Imm;
+            break;
+        case RV_JALR:
+            Address = (X[Instruction->Rs1] + Instruction->Imm) & ~1u;
+            X[Instruction->Rd] = Next;
+            Next = Address;
+            break;
+        case RV_BEQ:    if (X[Instruction->Rs1] == X[Instruction->Rs2]) Next = PC + Instruction->Imm; break;
+        case RV_BNE:    if (X[Instruction->Rs1] != X[Instruction->Rs2]) Next = PC + Instruction->Imm; break;
+        case RV_BLT:    if ((int32_t) X[Instruction->Rs1] < (int32_t) X[Instruction->Rs2]) Next = PC + Instruction->Imm; break;
+        case RV_BGE:    if ((int32_t) X[Instruction->Rs1] >= (int32_t) X[Instruction->Rs2]) Next = PC + Instruction->Imm; break;
+        case RV_BLTU:   if (X[Instruction->Rs1] < X[Instruction->Rs2]) Next = PC + Instruction->Imm; break;
+        case RV_BGEU:   if (X[Instruction->Rs1] >= X[Instruction->Rs2]) Next = PC + Instruction->Imm; break;
+        case RV_LB:
+        case RV_LH:
+        case RV_LW:
+        case RV_LBU:
+        case RV_LHU:
+            Address = X[Instruction->Rs1] + Instruction->Imm;
+            //Width from funct3: 1, 2 or 4 bytes
+            Execute_Trace_Operation(READ, Address, 1u << (RV_Encoding[Instruction->Opcode].Funct3 & 3));
+            X[Instruction->Rd] = RV_Load(Machine, Address, 1u << (RV_Encoding[Instruction->Opcode].Funct3 & 3));
+            if (Instruction->Opcode == RV_LB) X[Instruction->Rd] = RV_Sign_Extend(X[Instruction->Rd], 8);
+            if (Instruction->Opcode == RV_LH) X[Instruction->Rd] = RV_Sign_Extend(X[Instruction->Rd], 16);
+            break;
+        case RV_SB:
+        case RV_SH:
+        case RV_SW:
+            Address = X[Instruction->Rs1] + Instruction->Imm;
+            Execute_Trace_Operation(WRITE, Address, 1u << RV_Encoding[Instruction->Opcode].Funct3);
+            RV_Store(Machine, Address, X[Instruction->Rs2], 1u << RV_Encoding[Instruction->Opcode].Funct3);
+            break;
+        case RV_ADDI:   X[Instruction->Rd] = X[Instruction->Rs1] + Instruction->Imm; break;
+        case RV_SLTI:   X[Instruction->Rd] = (int32_t) X[Instruction->Rs1] < Instruction->Imm; break;
+        case RV_SLTIU:  X[Instruction->Rd] = X[Instruction->Rs1] < (uint32_t) Instruction->Imm; break;
+        case RV_XORI:   X[Instruction->Rd] = X[Instruction->Rs1] ^ Instruction->Imm; break;
+        case RV_ORI:    X[Instruction->Rd] = X[Instruction->Rs1] | Instruction->Imm; break;
+        case RV_ANDI:   X[Instruction->Rd] = X[Instruction->Rs1] & Instruction->Imm; break;
+        case RV_SLLI:   X[Instruction->Rd] = X[Instruction->Rs1] << Instruction->Imm; break;
+        case RV_SRLI:   X[Instruction->Rd] = X[Instruction->Rs1] >> Instruction->Imm; break;
+        case RV_SRAI:   X[Instruction->Rd] = (int32_t) X[Instruction->Rs1] >> Instruction->Imm; break;
+        case RV_ADD:    X[Instruction->Rd] = X[Instruction->Rs1] + X[Instruction->Rs2]; break;
+        case RV_SUB:    X[Instruction->Rd] = X[Instruction->Rs1] - X[Instruction->Rs2]; break;
+        case RV_SLL:    X[Instruction->Rd] = X[Instruction->Rs1] << (X[Instruction->Rs2] & 31); break;
+        case RV_SLT:    X[Instruction->Rd] = (int32_t) X[Instruction->Rs1] < (int32_t) X[Instruction->Rs2]; break;
+        case RV_SLTU:   X[Instruction->Rd] = X[Instruction->Rs1] < X[Instruction->Rs2]; break;
+        case RV_XOR:    X[Instruction->Rd] = X[Instruction->Rs1] ^ X[Instruction->Rs2]; break;
+        case RV_SRL:    X[Instruction->Rd] = X[Instruction->Rs1] >> (X[Instruction->Rs2] & 31); break;
+        case RV_SRA:    X[Instruction->Rd] = (int32_t) X[Instruction->Rs1] >> (X[Instruction->Rs2] & 31); break;
+        case RV_OR:     X[Instruction->Rd] = X[Instruction->Rs1] | X[Instruction->Rs2]; break;
+        case RV_AND:    X[Instruction->Rd] = X[Instruction->Rs1] & X[Instruction->Rs2]; break;
+        case RV_FENCE:  break;
+        default:
+            //ecall and ebreak stop the program
+            Machine->PC = Next;
+            return;
+        }
+        X[0] = 0;
+        Machine->PC = Next;
+    }
+}
+
+void RV_Release(RV_Machine_Typedef* Machine)
+{
+    for (uint32_t i = 0; i < Machine->Pages; i++) free(Machine->Page[i]);
+    free(Machine->Page);
+    free(Machine->Code);
+    free(Machine->Label);
+    Hash_Map_Release(&Machine->Page_Index);
+    Machine->Page = NULL;
+    Machine->Code = NULL;
+    Machine->Label = NULL;
+    Machine->Last_Page = NULL;
+    Machine->Pages = Machine->Labels = Machine->Words = 0;
+}
+
+//Trace importers
+bool Trace_Format_Select(const char* Name)
+{
+    for (uint8_t i = TRACE_NATIVE; i < TRACE_FORMATS; i++)
+    {
+        if (!strcmp(Name, Trace_Format_Name[i]))
+        {
+            Trace_Format = i;
+            return true;
+        }
+    }
+    printf("\033[31mERROR: Unknown trace format %s (native, din, champsim or lackey)\033[0m\n", Name);
+    return false;
+}
+
+uint8_t Trace_Format_Detect(const char* Trace_File)
+{
+    const char* Extension = (Trace_File != NULL) ? strrchr(Trace_File, '.') : NULL;
+
+    if (Extension == NULL) return TRACE_NATIVE;
+    if (!strcmp(Extension, ".din")) return TRACE_DINERO;
+    if (!strcmp(Extension, ".champsim") || !strcmp(Extension, ".champsimtrace")) return TRACE_CHAMPSIM;
+    if (!strcmp(Extension, ".lackey")) return TRACE_LACKEY;
+    return TRACE_NATIVE;
+}
+
+bool Run_Imported_Trace(FILE* fd)
+{
+    Trace_Importer_Typedef Importer;
+    Trace_Record_Typedef* Records = (Trace_Record_Typedef*) malloc(TRACE_CHUNK * sizeof(Trace_Record_Typedef));
+    uint64_t Count;
+    bool OK = (Records != NULL) && Import_Init(&Importer, fd, Trace_Format);
+
+    while (OK && (Convergence.Converged == false) && ((Count = Import_Fill(&Importer, Records, TRACE_CHUNK)) > 0)) Execute_Trace_Records(Records, Count);
+    //The imported formats have no PRINT_LOG: the run ends with one like the hand-translated vectors
+    if (OK && (Convergence.Converged == false)) Execute_Trace_Operation(PRINT_LOG, 0, 0);
+    if (OK) Import_Release(&Importer);
+    free(Records);
+    return OK;
+}
+
+bool Import_Init(Trace_Importer_Typedef* Importer, FILE* fd, uint8_t Format)
+{
+    Importer->File = fd;
+    Importer->Format = Format;
+    Importer->Length = Importer->Position = 0;
+    Importer->End = false;
+    return (Importer->Block = (char*) malloc(IMPORT_BLOCK + 1)) != NULL;
+}
+
+void Import_Release(Trace_Importer_Typedef* Importer)
+{
+    free(Importer->Block);
+    Importer->Block = NULL;
+}
+
+//Keeps the undecoded bytes and reads after them, false when nothing was added
+bool Import_Refill(Trace_Importer_Typedef* Importer)
+{
+    size_t Left = Importer->Length - Importer->Position;
+
+    if (Importer->End) return false;
+    memmove(Importer->Block, &Importer->Block[Importer->Position], Left);
+    Importer->Length = Left + fread(&Importer->Block[Left], 1, IMPORT_BLOCK - Left, Importer->File);
+    Importer->Position = 0;
+    //fread only returns less than asked at the end of the file
+    if (Importer->Length < IMPORT_BLOCK) Importer->End = true;
+    return Importer->Length > Left;
+}
+
+//Next line of a text trace, terminated in place; lines longer than the block are cut
+char* Import_Line(Trace_Importer_Typedef* Importer)
+{
+    char* Line;
+    char* End = (char*) memchr(&Importer->Block[Importer->Position], '\n', Importer->Length - Importer->Position);
+
+    if ((End == NULL) && Import_Refill(Importer)) End = (char*) memchr(&Importer->Block[Importer->Position], '\n', Importer->Length - Importer->Position);
+    if (End == NULL)
+    {
+        if (Importer->Position == Importer->Length) return NULL;
+        End = &Importer->Block[Importer->Length];
+    }
+    Line = &Importer->Block[Importer->Position];
+    *End = '\0';
+    Importer->Position = (End < &Importer->Block[Importer->Length]) ? (size_t)(End - Importer->Block) + 1 : Importer->Length;
+    return Line;
+}
+
+//Hexadecimal number with an optional 0x, Text is left after it
+uint64_t Import_Hex(const char** Text)
+{
+    const char* Cursor = *Text;
+    uint64_t Value = 0;
+    uint8_t Digit;
+
+    if ((Cursor[0] == '0') && ((Cursor[1] == 'x') || (Cursor[1] == 'X'))) Cursor += 2;
+    while (true)
+    {
+        if ((*Cursor >= '0') && (*Cursor <= '9')) Digit = *Cursor - '0';
+        else if (((*Cursor | 0x20) >= 'a') && ((*Cursor | 0x20) <= 'f')) Digit = (*Cursor | 0x20) - 'a' + 10;
+        else break;
+        Value = (Value << 4) | Digit;
+        Cursor++;
+    }
+    *Text = Cursor;
+    return Value;
+}
+
+uint64_t Import_Fill(Trace_Importer_Typedef* Importer, Trace_Record_Typedef* Records, uint64_t Count)
+{
+    ChampSim_Record_Typedef Instruction;
+    char* Line;
+    uint64_t Done = 0;
+
+    while (Done + IMPORT_EXPAND <= Count)
+    {
+        if (Importer->Format == TRACE_CHAMPSIM)
+        {
+            //A truncated last record is dropped
+            if (Importer->Length - Importer->Position < sizeof(Instruction))
+            {
+                Import_Refill(Importer);
+                if (Importer->Length - Importer->Position < sizeof(Instruction)) break;
+            }
+            memcpy(&Instruction, &Importer->Block[Importer->Position], sizeof(Instruction));
+            Importer->Position += sizeof(Instruction);
+            Done += Import_ChampSim(&Instruction, &Records[Done]);
+        }
+        else if ((Line = Import_Line(Importer)) == NULL) break;
+        else if (Importer->Format == TRACE_DINERO) Done += Import_Dinero(Line, &Records[Done]);
+        else Done += Import_Lackey(Line, &Records[Done]);
+    }
+    return Done;
+}
+
+//"label address": 0 read, 1 write, 2 fetch; escapes (3) and flushes (4) have no access
+uint8_t Import_Dinero(const char* Line, Trace_Record_Typedef* Records)
+{
+    const char* Cursor = Line + strspn(Line, " \t");
+    const char* Address;
+
+    if ((Cursor[0] < '0') || (Cursor[0] > '2') || ((Cursor[1] != ' ') && (Cursor[1] != '\t'))) return 0;
+    Records[0].Operation = (Cursor[0] == '0') ? READ : (Cursor[0] == '1') ? WRITE : FETCH;
+    Cursor += 1 + strspn(Cursor + 1, " \t");
+    Address = Cursor;
+    Records[0].Address = Import_Hex(&Cursor);
+    Records[0].Size = 0;
+    return Cursor != Address;
+}
+
+//"I  address,size" for instructions, " L", " S" or " M" (load then store) for data; the "==pid==" lines are skipped
+uint8_t Import_Lackey(const char* Line, Trace_Record_Typedef* Records)
+{
+    const char* Cursor = Line + strspn(Line, " ");
+    const char* Address;
+    char Kind = *Cursor;
+
+    if ((Kind != 'I') && (Kind != 'L') && (Kind != 'S') && (Kind != 'M')) return 0;
+    Cursor += 1 + strspn(Cursor + 1, " ");
+    Address = Cursor;
+    Records[0].Address = Import_Hex(&Cursor);
+    if ((Cursor == Address) || (*Cursor != ',')) return 0;
+    Records[0].Size = strtoul(Cursor + 1, NULL, 10);
+    Records[0].Operation = (Kind == 'I') ? FETCH : (Kind == 'S') ? WRITE : READ;
+    if (Kind != 'M') return 1;
+    Records[1] = Records[0];
+    Records[1].Operation = WRITE;
+    return 2;
+}
+
+//The fetch of the instruction, then its loads and stores; 0 marks an unused operand
+uint8_t Import_ChampSim(const ChampSim_Record_Typedef* Instruction, Trace_Record_Typedef* Records)
+{
+    uint8_t Count = 0;
+
+    Records[Count].Operation = FETCH;
+    Records[Count].Address = Instruction->IP;
+    Records[Count++].Size = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if (Instruction->Source_Memory[i] == 0) continue;
+        Records[Count].Operation = READ;
+        Records[Count].Address = Instruction->Source_Memory[i];
+        Records[Count++].Size = 0;
+    }
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (Instruction->Destination_Memory[i] == 0) continue;
+        Records[Count].Operation = WRITE;
+        Records[Count].Address = Instruction->Destination_Memory[i];
+        Records[Count++].Size = 0;
+    }
+    return Count;
+}
+
+#ifdef CACHE_PROFILE
+//Self-profiling
+uint64_t Profile_NS()
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t) Now.tv_sec * 1000000000ull + Now.tv_nsec;
+}
+
+uint64_t Profile_Ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return Profile_NS();
+#endif
+}
+
+void Profile_Scope_End(Profile_Scope_Typedef* Scope)
+{
+    Profile.Ticks[Scope->Phase] += Profile_Ticks() - Scope->Start;
+}
+
+void Profile_Start()
+{
+    Profile.Start_NS = Profile_NS();
+    Profile.Start_Ticks = Profile_Ticks();
+    Profile.Next_Progress_NS = Profile.Start_NS + Profile.Progress_NS;
+}
+
+void Profile_Count(unsigned int Operation)
+{
+    if (Operation >= 10) return;
+    Profile.Calls[Operation]++;
+    //The clock is only read once every 64K operations
+    if ((Profile.Progress_NS > 0) && ((Profile.Calls[Operation] & 0xFFFF) == 0)) Profile_Progress();
+}
+
+void Profile_Progress()
+{
+    uint64_t Now = Profile_NS();
+    uint64_t Accesses = Profile.Calls[READ] + Profile.Calls[WRITE] + Profile.Calls[FETCH];
+    double Seconds = (Now - Profile.Start_NS) / 1e9;
+
+    if (Now < Profile.Next_Progress_NS) return;
+    Profile.Next_Progress_NS = Now + Profile.Progress_NS;
+    fprintf(stderr, "progress: %.1fs, %" PRIu64 " accesses, %.3f M accesses/s, %.1f ns/access\n",
+    Seconds, Accesses, Accesses / Seconds / 1e6, (Accesses == 0) ? 0.0 : (Now - Profile.Start_NS) / (double) Accesses);
+}
+
+void Print_Profile_Report()
+{
+    const char* Name[PROFILE_PHASES] = {"Parse (read + parse lines)", "Dispatch and models", "Lookup (tag match)", "Replacement (LRU)", "Logging", "Reports (PRINT_LOG)"};
+    uint64_t Elapsed_NS = Profile_NS() - Profile.Start_NS;
+    uint64_t Elapsed_Ticks = Profile_Ticks() - Profile.Start_Ticks;
+    uint64_t Accesses = Profile.Calls[READ] + Profile.Calls[WRITE] + Profile.Calls[FETCH];
+    double NS_Per_Tick = (Elapsed_Ticks == 0) ? 0.0 : (double) Elapsed_NS / Elapsed_Ticks;
+    int64_t Exclusive[PROFILE_PHASES];
+
+    if (Quiet) return;
+    Async_Log_Drain();
+    //Inclusive to exclusive: parsing is the loop minus execution, dispatch is execution minus the timed parts inside it
+    Exclusive[0] = Profile.Ticks[PROFILE_RUN] - Profile.Ticks[PROFILE_EXECUTE];
+    Exclusive[1] = Profile.Ticks[PROFILE_EXECUTE] - Profile.Ticks[PROFILE_LOOKUP] - Profile.Ticks[PROFILE_REPLACEMENT] - Profile.Ticks[PROFILE_LOGGING] - Profile.Ticks[PROFILE_REPORT];
+    for (uint8_t i = 2; i < PROFILE_PHASES; i++) Exclusive[i] = Profile.Ticks[i];
+    printf("\033[32m==============================================================================================================\033[0m\n");
+    printf("\033[32m\033[4;1mSIMULATOR PROFILE:\n\033[0m\n");
+    printf("\033[32m\t+%" PRIu64 " accesses in %.3f s: %.3f M accesses/s, %.1f ns/access\033[0m\n", Accesses, Elapsed_NS / 1e9,
+    (Elapsed_NS == 0) ? 0.0 : Accesses * 1e3 / Elapsed_NS, (Accesses == 0) ? 0.0 : (double) Elapsed_NS / Accesses);
+    for (uint8_t i = 0; i < PROFILE_PHASES; i++)
+    {
+        printf("\033[32m\t   %-28s %10.3f s %6.2f%% %8.1f ns/access\033[0m\n", Name[i], Exclusive[i] * NS_Per_Tick / 1e9,
+        (Profile.Ticks[PROFILE_RUN] == 0) ? 0.0 : 100.0 * Exclusive[i] / Profile.Ticks[PROFILE_RUN], (Accesses == 0) ? 0.0 : Exclusive[i] * NS_Per_Tick / Accesses);
+    }
+    printf("\033[32m\t+Operations: read %" PRIu64 ", write %" PRIu64 ", fetch %" PRIu64 ", evict %" PRIu64 ", reset %" PRIu64 ", print %" PRIu64 "\033[0m\n",
+    Profile.Calls[READ], Profile.Calls[WRITE], Profile.Calls[FETCH], Profile.Calls[EVICT], Profile.Calls[RESET_AND_CLEAR], Profile.Calls[PRINT_LOG]);
+}
+#endif
 /* END User function */
\ No newline at end of file
@@ -0,0 +1,270 @@
+/* Micro-benchmarks of the hot paths of Cache.c: ns per operation of each path in isolation
+*  Build (from the repository root): gcc -W -Wall -O2 -DCACHE_RELEASE -o Cache_Bench.exe Tools/Cache_Bench.c -lpthread
+*  Usage: ./Cache_Bench.exe [--samples=101] [--batch=1024] [--only=<benchmark>] [--json=<file>]
+*  Every sample prepares the caches (not timed), then times a batch of operations on distinct sets.
+*  Warm runs repeat the batch on lines already in the host caches, cold runs flush the host caches before each batch.
+*  Results go to stdout (or --json) as one JSON document, the simulator output of PRINT_LOG goes to /dev/null
+*/
+#define CACHE_NO_MAIN
+#include "../Cache.c"
+
+#define BENCH_SAMPLES   101        //Default samples per benchmark and host cache state
+#define BENCH_BATCH     1024       //Default operations timed in one sample
+#define FLUSH_BYTES     (64 << 20) //Buffer streamed to evict the host caches
+
+typedef struct {
+    const char* Name;
+    void (*Setup)(uint32_t Batch);      //Untimed preparation of the caches
+    void (*Run)(uint32_t Index);        //One timed operation
+    uint32_t Batch;                     //Operations per sample, 0 for the --batch value
+} Bench_Typedef;
+
+typedef struct {
+    double Min;
+    double P50;
+    double P90;
+    double P99;
+    double Max;
+} Bench_Result_Typedef;
+
+volatile uint8_t* Flush_Buffer = NULL;
+
+//Line of tag Tag in the Index-th set of a batch; sets are spread so the host prefetcher does not follow them
+Address_Typedef Bench_Address(uint32_t Index, uint32_t Tag)
+{
+    Set_Typedef Set = (Index * 97) % NUM_OF_SET;
+
+    return ((Address_Typedef) Tag << (SET_BIT + BYTE_BIT)) | ((Address_Typedef) Set << BYTE_BIT);
+}
+
+void Fill_Sets(uint32_t Batch, bool Dirty, bool Instruction)
+{
+    Reset_And_Clear_Cache();
+    for (uint32_t i = 0; i < Batch; i++)
+    {
+        for (uint32_t Way = 0; Way < (Instruction ? INSTR_WAYS : DATA_WAYS); Way++)
+        {
+            if (Instruction) Instruction_Cache_Fetch(Bench_Address(i, Way + 1));
+            else if (Dirty) Data_Cache_Write(Bench_Address(i, Way + 1));
+            else Data_Cache_Read(Bench_Address(i, Way + 1));
+        }
+    }
+}
+
+//Preparation of each benchmark
+void Setup_Empty(uint32_t Batch)
+{
+    (void) Batch;
+    Reset_And_Clear_Cache();
+}
+
+void Setup_Clean(uint32_t Batch)
+{
+    Fill_Sets(Batch, false, false);
+}
+
+void Setup_Dirty(uint32_t Batch)
+{
+    Fill_Sets(Batch, true, false);
+}
+
+void Setup_Instruction(uint32_t Batch)
+{
+    Fill_Sets(Batch, false, true);
+}
+
+//Whole-cache operations (print_log, reset) run once per sample on the same filled sets
+void Setup_Print(uint32_t Batch)
+{
+    (void) Batch;
+    Fill_Sets(BENCH_BATCH, false, false);
+}
+
+//Timed operations
+void Run_Read_Hit(uint32_t Index)
+{
+    Data_Cache_Read(Bench_Address(Index, 1));
+}
+
+void Run_Read_Miss(uint32_t Index)
+{
+    //Tag beyond the filled ways: empty way after a reset, LRU victim in a full set
+    Data_Cache_Read(Bench_Address(Index, DATA_WAYS + 1));
+}
+
+void Run_Write_Hit(uint32_t Index)
+{
+    Data_Cache_Write(Bench_Address(Index, 1));
+}
+
+void Run_Fetch_Hit(uint32_t Index)
+{
+    Instruction_Cache_Fetch(Bench_Address(Index, 1));
+}
+
+void Run_Fetch_Miss(uint32_t Index)
+{
+    Instruction_Cache_Fetch(Bench_Address(Index, INSTR_WAYS + 1));
+}
+
+void Run_L2_Evict(uint32_t Index)
+{
+    L2_Evict_Command_to_L1(Bench_Address(Index, 1));
+}
+
+void Run_Print_Log(uint32_t Index)
+{
+    (void) Index;
+    Print_Content_And_State();
+}
+
+void Run_Reset(uint32_t Index)
+{
+    (void) Index;
+    Reset_And_Clear_Cache();
+}
+
+Bench_Typedef Benches[] = {
+    {"read_hit", Setup_Clean, Run_Read_Hit, 0},
+    {"read_miss_empty_way", Setup_Empty, Run_Read_Miss, 0},
+    {"read_miss_clean_evict", Setup_Clean, Run_Read_Miss, 0},
+    {"read_miss_dirty_write_back", Setup_Dirty, Run_Read_Miss, 0},
+    {"write_hit", Setup_Clean, Run_Write_Hit, 0},
+    {"fetch_hit", Setup_Instruction, Run_Fetch_Hit, 0},
+    {"fetch_miss_evict", Setup_Instruction, Run_Fetch_Miss, 0},
+    {"l2_evict", Setup_Dirty, Run_L2_Evict, 0},
+    {"print_log", Setup_Print, Run_Print_Log, 1},
+    {"reset", Setup_Print, Run_Reset, 1}
+};
+
+uint64_t Bench_NS()
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t) Now.tv_sec * 1000000000ull + Now.tv_nsec;
+}
+
+void Flush_Host_Caches()
+{
+    for (uint32_t i = 0; i < FLUSH_BYTES; i += 64) Flush_Buffer[i]++;
+}
+
+int Compare_Double(const void* First, const void* Second)
+{
+    double First_Value = *(const double*) First;
+    double Second_Value = *(const double*) Second;
+
+    return (First_Value > Second_Value) - (First_Value < Second_Value);
+}
+
+bool Run_Bench(Bench_Typedef* Bench, uint32_t Samples, uint32_t Batch, bool Cold, Bench_Result_Typedef* Result)
+{
+    double* Time = (double*) malloc(Samples * sizeof(double));
+    uint64_t Start;
+
+    if (Time == NULL) return false;
+    if (Bench->Batch > 0) Batch = Bench->Batch;
+    //Warm-up sample, not recorded
+    Bench->Setup(Batch);
+    for (uint32_t i = 0; i < Batch; i++) Bench->Run(i);
+    for (uint32_t Sample = 0; Sample < Samples; Sample++)
+    {
+        Bench->Setup(Batch);
+        if (Cold) Flush_Host_Caches();
+        Start = Bench_NS();
+        for (uint32_t i = 0; i < Batch; i++) Bench->Run(i);
+        Time[Sample] = (double)(Bench_NS() - Start) / Batch;
+    }
+    qsort(Time, Samples, sizeof(double), Compare_Double);
+    Result->Min = Time[0];
+    Result->P50 = Time[Samples / 2];
+    Result->P90 = Time[(uint32_t)(0.90 * (Samples - 1))];
+    Result->P99 = Time[(uint32_t)(0.99 * (Samples - 1))];
+    Result->Max = Time[Samples - 1];
+    free(Time);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    /* BEGIN Main: Local variable */
+    uint32_t Samples = BENCH_SAMPLES;
+    uint32_t Batch = BENCH_BATCH;
+    char* Only = NULL;
+    char* JSON_File = NULL;
+    char* Value;
+    FILE* Output;
+    int Output_Fd;
+    bool First = true;
+    Bench_Result_Typedef Result;
+    /* END Main: Local variable */
+
+    /* BEGIN Code */
+    for (int i = 1; i < argc; i++)
+    {
+        if ((Value = Option_Value(argv[i], "--samples"))) Samples = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--batch"))) Batch = strtoul(Value, NULL, 0);
+        else if ((Value = Option_Value(argv[i], "--only"))) Only = Value;
+        else if ((Value = Option_Value(argv[i], "--json"))) JSON_File = Value;
+        else
+        {
+            printf("\033[31mERROR: Unknown option %s\033[0m\n", argv[i]);
+            return 1;
+        }
+    }
+    if ((Samples < 1) || (Batch < 1) || (Batch > NUM_OF_SET))
+    {
+        printf("\033[31mERROR: Samples must be positive and the batch between 1 and %d\033[0m\n", NUM_OF_SET);
+        return 1;
+    }
+    //The report of PRINT_LOG is timed but not shown: results keep the real stdout
+    if (JSON_File != NULL) Output = fopen(JSON_File, "w");
+    else Output = ((Output_Fd = dup(fileno(stdout))) >= 0) ? fdopen(Output_Fd, "w") : NULL;
+    Flush_Buffer = (volatile uint8_t*) calloc(FLUSH_BYTES, 1);
+    if ((Output == NULL) || (Flush_Buffer == NULL) || (freopen("/dev/null", "w", stdout) == NULL))
+    {
+        fprintf(stderr, "ERROR: Cannot open the output\n");
+        return 1;
+    }
+    Mode = 0;
+    if (Simulation_Init() == false)
+    {
+        fprintf(stderr, "ERROR: Cannot allocate the simulation models\n");
+        return 1;
+    }
+
+    fprintf(Output, "{\"version\":1,\"address_bit\":%d,\"release\":%s,\"compiler\":\"%s\",\"samples\":%u,\"batch\":%u,\"unit\":\"ns/op\",\"results\":[",
+    ADDRESS_BIT,
+#ifdef CACHE_RELEASE
+    "true",
+#else
+    "false",
+#endif
+    __VERSION__, Samples, Batch);
+    for (uint32_t i = 0; i < sizeof(Benches) / sizeof(Benches[0]); i++)
+    {
+        if ((Only != NULL) && strcmp(Only, Benches[i].Name)) continue;
+        for (uint8_t Cold = 0; Cold < 2; Cold++)
+        {
+            if (Run_Bench(&Benches[i], Samples, Batch, Cold, &Result) == false)
+            {
+                fprintf(stderr, "ERROR: Cannot allocate the samples of %s\n", Benches[i].Name);
+                fclose(Output);
+                Simulation_Release();
+                free((void*) Flush_Buffer);
+                return 1;
+            }
+            fprintf(Output, "%s\n{\"name\":\"%s\",\"host_cache\":\"%s\",\"min\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f}",
+            First ? "" : ",", Benches[i].Name, Cold ? "cold" : "warm", Result.Min, Result.P50, Result.P90, Result.P99, Result.Max);
+            First = false;
+        }
+    }
+    fprintf(Output, "\n]}\n");
+    fclose(Output);
+    Simulation_Release();
+    free((void*) Flush_Buffer);
+    /* END Code */
+
+    return 0;
+}
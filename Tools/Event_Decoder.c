@@ -0,0 +1,53 @@
+/* Event log decoder: renders a binary event log written with --event-log as the Mode 1 messages
+*  Build (from the repository root): gcc -W -Wall -O2 -o Event_Decoder.exe Tools/Event_Decoder.c -lpthread
+*  Usage: ./Event_Decoder.exe <event log> [hit_show]
+*  Logs of a simulator built with -DADDRESS_BIT=64 need a decoder built with the same flag
+*/
+#define CACHE_NO_MAIN
+#include "../Cache.c"
+
+int main(int argc, char* argv[])
+{
+    /* BEGIN Main: Local variable */
+    FILE *fd = NULL;
+    Event_Log_Header_Typedef Header;
+    Cache_Event_Typedef* Events;
+    size_t Count;
+    int Show_Hits = 0;
+    /* END Main: Local variable */
+
+    /* BEGIN Code */
+    if (argc < 2)
+    {
+        printf("\033[31mERROR: Event log name not found!\033[0m\n");
+        return 1;
+    }
+    if (argc > 2) Show_Hits = atoi(argv[2]);
+    if ((fd = fopen(argv[1], "rb")) == NULL)
+    {
+        printf("\033[31mERROR: Cannot open event log!\033[0m\n");
+        return 1;
+    }
+    if ((fread(&Header, sizeof(Header), 1, fd) != 1) || strcmp(Header.Magic, "L1EVENT") || (Header.Version != EVENT_VERSION))
+    {
+        printf("\033[31mERROR: %s is not an event log!\033[0m\n", argv[1]);
+        fclose(fd);
+        return 1;
+    }
+    if (Header.Address_Bit != ADDRESS_BIT)
+    {
+        printf("\033[31mERROR: The log has %u-bit addresses, rebuild with -DADDRESS_BIT=%u\033[0m\n", Header.Address_Bit, Header.Address_Bit);
+        fclose(fd);
+        return 1;
+    }
+    Events = (Cache_Event_Typedef*) malloc(EVENT_BUFFER * sizeof(Cache_Event_Typedef));
+    while ((Count = fread(Events, sizeof(Cache_Event_Typedef), EVENT_BUFFER, fd)) > 0)
+    {
+        for (size_t i = 0; i < Count; i++) Print_Cache_Event(stdout, &Events[i], Show_Hits);
+    }
+    free(Events);
+    fclose(fd);
+    /* END Code */
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+#!/bin/bash
+# Release build benchmark: times the documented build (-O0) against the release build (-DCACHE_RELEASE)
+# Usage (from the repository root): Tools/Release_Benchmark.sh [accesses of the synthetic trace] [repeats of Final_Tests]
+# BASE_CFLAGS / RELEASE_CFLAGS override the compiler flags of the two builds
+ACCESSES=${1:-5000000}
+REPEATS=${2:-200}
+BASE_CFLAGS=${BASE_CFLAGS:--O0}
+RELEASE_CFLAGS=${RELEASE_CFLAGS:--O2 -DCACHE_RELEASE}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+TIMEFORMAT=%R
+
+gcc -W -Wall $BASE_CFLAGS -o "$WORK/Base.exe" Cache.c -lpthread || exit 1
+gcc -W -Wall $RELEASE_CFLAGS -o "$WORK/Release.exe" Cache.c -lpthread || exit 1
+
+# Synthetic traces: uniform random lines over 64MB, and a 4MB loop (mostly hits)
+awk -v n="$ACCESSES" 'BEGIN { srand(1); for (i = 0; i < n; i++) printf "%d %x\n", int(rand() * 3), int(rand() * 67108864) }' > "$WORK/Random.txt"
+awk -v n="$ACCESSES" 'BEGIN { for (i = 0; i < n; i++) printf "%d %x\n", i % 3, (i * 64) % 4194304 }' > "$WORK/Loop.txt"
+
+Run_Traces()
+{
+    for i in $(seq "$REPEATS"); do
+        for Trace in Final_Tests/*.txt; do "$1" "$Trace" 0 --mode=0 > /dev/null; done
+    done
+}
+
+printf "%-28s %10s %10s\n" "Workload" "Base (s)" "Release (s)"
+Base=$( { time Run_Traces "$WORK/Base.exe"; } 2>&1 )
+Release=$( { time Run_Traces "$WORK/Release.exe"; } 2>&1 )
+printf "%-28s %10s %10s\n" "Final_Tests x$REPEATS" "$Base" "$Release"
+for Trace in Random Loop; do
+    for Mode in 0 1; do
+        Base=$( { time "$WORK/Base.exe" "$WORK/$Trace.txt" 1 --mode=$Mode > /dev/null; } 2>&1 )
+        Release=$( { time "$WORK/Release.exe" "$WORK/$Trace.txt" 1 --mode=$Mode > /dev/null; } 2>&1 )
+        printf "%-28s %10s %10s\n" "$Trace $ACCESSES mode $Mode" "$Base" "$Release"
+    done
+done
@@ -0,0 +1,135 @@
+/* Synthetic trace generator: writes the gen:<pattern> traces of the simulator as text or binary
+*  Build (from the repository root): gcc -W -Wall -O2 -o Trace_Gen.exe Tools/Trace_Gen.c -lpthread
+*  Usage: ./Trace_Gen.exe <sequential|stride|random|zipf|chase|mix> [--gen-count=N] [--gen-footprint=BYTES] [--gen-base=ADDR]
+*         [--gen-stride=BYTES] [--gen-code=BYTES] [--gen-seed=N] [--gen-size=BYTES] [--gen-theta=T] [--gen-write=P] [--gen-fetch=P]
+*         [--binary] [--output=<file>]
+*  Without --output the trace goes to stdout and can be piped: ./Trace_Gen.exe zipf --binary | ./Cache.exe - --mode=0
+*  The same options give the same records as ./Cache.exe gen:<pattern>, which generates them in process
+*/
+#define CACHE_NO_MAIN
+#include "../Cache.c"
+
+#define TEXT_BUFFER     (1 << 20)  //Text formatted before one write
+#define TEXT_RECORD     48         //Longest text record
+
+const char Hex_Digit[] = "0123456789abcdef";
+
+//"op address[ size]" like the bundled traces, without printf
+size_t Format_Trace_Record(char* Text, const Trace_Record_Typedef* Record)
+{
+    uint64_t Value = Record->Address;
+    size_t Length = 2 + ((Value == 0) ? 1 : (67 - __builtin_clzll(Value)) / 4);
+    char Digit[10];
+    int Count = 0;
+
+    //The digit count is known up front, so the address is written in place from its last digit
+    Text[0] = '0' + Record->Operation;
+    Text[1] = ' ';
+    for (size_t i = Length - 1; i >= 2; i--)
+    {
+        Text[i] = Hex_Digit[Value & 15];
+        Value >>= 4;
+    }
+    if (Record->Size > 0)
+    {
+        Text[Length++] = ' ';
+        for (Value = Record->Size; Value > 0; Value /= 10) Digit[Count++] = '0' + Value % 10;
+        while (Count > 0) Text[Length++] = Digit[--Count];
+    }
+    Text[Length++] = '\n';
+    return Length;
+}
+
+
+int main(int argc, char* argv[])
+{
+    /* BEGIN Main: Local variable */
+    FILE* Output = stdout;
+    char* Output_File = NULL;
+    char* Value;
+    bool Binary = false;
+    Trace_File_Header_Typedef Header = {"L1TRACE", TRACE_VERSION, sizeof(Trace_Record_Typedef)};
+    Trace_Record_Typedef* Records;
+    Trace_Record_Typedef Report = {0, 0, PRINT_LOG};
+    char* Text;
+    size_t Length;
+    uint64_t Count;
+    uint64_t Bytes = 0;
+    uint64_t Start;
+    double Seconds;
+    struct timespec Now;
+    bool OK = true;
+    /* END Main: Local variable */
+
+    /* BEGIN Code */
+    if (argc < 2)
+    {
+        fprintf(stderr, "ERROR: Trace pattern not found (sequential, stride, random, zipf, chase or mix)\n");
+        return 1;
+    }
+    for (int i = 2; i < argc; i++)
+    {
+        if (Parse_Generator_Option(argv[i])) continue;
+        else if (!strcmp(argv[i], "--binary")) Binary = true;
+        else if ((Value = Option_Value(argv[i], "--output"))) Output_File = Value;
+        else
+        {
+            fprintf(stderr, "ERROR: Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if ((Generator_Select(argv[1]) == false) || (Generator_Init(&Generator) == false))
+    {
+        fprintf(stderr, "ERROR: Cannot set up the %s generator\n", argv[1]);
+        return 1;
+    }
+    if ((Output_File != NULL) && ((Output = fopen(Output_File, Binary ? "wb" : "w")) == NULL))
+    {
+        fprintf(stderr, "ERROR: Cannot open %s\n", Output_File);
+        return 1;
+    }
+    Records = (Trace_Record_Typedef*) calloc(TRACE_CHUNK, sizeof(Trace_Record_Typedef));
+    Text = (char*) malloc(TEXT_BUFFER);
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    Start = (uint64_t) Now.tv_sec * 1000000000ull + Now.tv_nsec;
+    if (Binary) OK = (fwrite(&Header, sizeof(Header), 1, Output) == 1);
+    while (OK && ((Count = Generator_Fill(&Generator, Records, TRACE_CHUNK)) > 0))
+    {
+        if (Binary)
+        {
+            OK = (fwrite(Records, sizeof(Trace_Record_Typedef), Count, Output) == Count);
+            Bytes += Count * sizeof(Trace_Record_Typedef);
+            continue;
+        }
+        Length = 0;
+        for (uint64_t i = 0; i < Count; i++)
+        {
+            Length += Format_Trace_Record(&Text[Length], &Records[i]);
+            if ((Length > TEXT_BUFFER - TEXT_RECORD) || (i == Count - 1))
+            {
+                OK = OK && (fwrite(Text, 1, Length, Output) == Length);
+                Bytes += Length;
+                Length = 0;
+            }
+        }
+    }
+    //Like the hand-translated vectors, the trace ends with a PRINT_LOG so the simulator reports the final state
+    if (Binary) OK = OK && (fwrite(&Report, sizeof(Report), 1, Output) == 1);
+    else OK = OK && (fputs("9\n", Output) >= 0);
+    Bytes += Binary ? sizeof(Report) : 2;
+    if (fclose(Output) != 0) OK = false;
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    Seconds = ((uint64_t) Now.tv_sec * 1000000000ull + Now.tv_nsec - Start) / 1e9;
+    fprintf(stderr, "%" PRIu64 " records, %" PRIu64 " bytes in %.3f s (%.2f GB/s)\n", Generator.Done, Bytes, Seconds, (Seconds > 0.0) ? Bytes / Seconds / 1e9 : 0.0);
+    Generator_Release(&Generator);
+    free(Records);
+    free(Text);
+    if (OK == false)
+    {
+        fprintf(stderr, "ERROR: Cannot write the trace\n");
+        return 1;
+    }
+    /* END Code */
+
+    return 0;
+}